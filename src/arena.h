@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+// Арена (bump-аллокатор) потока: память выделяется сдвигом указателя внутри больших блоков.
+// Освобождение последнего выделенного участка возвращает его арене (стековый порядок),
+// остальные освобождения ничего не делают - память возвращается целиком через reset() или ArenaScope
+class ThreadArena {
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;  // Размер обычного блока
+
+  struct Block {
+    char *memory;
+    size_t size;
+  };
+  vector<Block> blocks;  // Выделенные блоки, текущий - последний
+  size_t used = 0;       // Занято байт в текущем блоке
+  size_t allocations = 0;  // Сколько раз арена обращалась к системному аллокатору
+
+  ThreadArena() = default;
+
+ public:
+  // Положение арены, к которому можно вернуться
+  struct Mark {
+    size_t block;
+    size_t used;
+  };
+
+  ThreadArena(const ThreadArena &) = delete;
+  ThreadArena &operator=(const ThreadArena &) = delete;
+  ~ThreadArena() {
+    for (auto &b : blocks) ::operator delete(b.memory);
+  }
+
+  // Арена текущего потока
+  static ThreadArena &local() {
+    thread_local ThreadArena arena;
+    return arena;
+  }
+
+  void *allocate(size_t bytes, size_t align) {
+    if (!blocks.empty()) {
+      size_t start = (used + align - 1) & ~(align - 1);
+      if (start + bytes <= blocks.back().size) {
+        used = start + bytes;
+        return blocks.back().memory + start;
+      }
+    }
+    // Новый блок: обычного размера или под один большой запрос
+    size_t size = max(BLOCK_SIZE, bytes + align);
+    auto *memory = static_cast<char *>(::operator new(size));
+    allocations++;
+    blocks.push_back({memory, size});
+    size_t start = (reinterpret_cast<uintptr_t>(memory) + align - 1) / align * align - reinterpret_cast<uintptr_t>(memory);
+    used = start + bytes;
+    return memory + start;
+  }
+
+  // Возврат последнего выделенного участка; для остальных - ничего не делаем
+  void deallocate(void *p, size_t bytes) {
+    if (!blocks.empty() && static_cast<char *>(p) + bytes == blocks.back().memory + used) {
+      used = static_cast<char *>(p) - blocks.back().memory;
+    }
+  }
+
+  [[nodiscard]] Mark mark() const { return {blocks.size(), used}; }
+
+  // Вернуться к сохранённому положению: всё выделенное после mark освобождается
+  void rewind(const Mark &m) {
+    while (blocks.size() > max<size_t>(m.block, 1)) {
+      ::operator delete(blocks.back().memory);
+      blocks.pop_back();
+    }
+    used = m.block == 0 ? 0 : m.used;
+  }
+
+  // Освободить всё выделенное (первый блок остаётся для повторного использования)
+  void reset() { rewind({0, 0}); }
+
+  // Количество обращений к системному аллокатору
+  [[nodiscard]] size_t systemAllocations() const { return allocations; }
+};
+
+// Область действия арены: всё, что выделено из арены потока внутри области, освобождается при выходе
+class ArenaScope {
+  ThreadArena::Mark saved;
+
+ public:
+  ArenaScope() : saved(ThreadArena::local().mark()) {}
+  ArenaScope(const ArenaScope &) = delete;
+  ArenaScope &operator=(const ArenaScope &) = delete;
+  ~ArenaScope() { ThreadArena::local().rewind(saved); }
+};
+
+// Аллокатор в стиле STL, выделяющий память из арены текущего потока.
+// Подходит для DynamicArray/ArraySequence и стандартных контейнеров
+template <class T>
+struct ArenaAllocator {
+  using value_type = T;
+
+  ArenaAllocator() = default;
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U> &) {}  // NOLINT: преобразование между типами элементов
+
+  T *allocate(size_t n) { return static_cast<T *>(ThreadArena::local().allocate(n * sizeof(T), alignof(T))); }
+  void deallocate(T *p, size_t n) { ThreadArena::local().deallocate(p, n * sizeof(T)); }
+
+  friend bool operator==(const ArenaAllocator &, const ArenaAllocator &) { return true; }
+  friend bool operator!=(const ArenaAllocator &, const ArenaAllocator &) { return false; }
+};
+
+// Арена объектов T с доступом по номеру: объекты лежат в блоках по ChunkSize штук,
+// выделение - сдвиг счётчика, поэтому подряд выделенные номера идут подряд, а адреса объектов
+// не меняются при росте. Отдельные объекты не освобождаются - только вся арена целиком
+template <class T, size_t ChunkSize = 1024>
+class ChunkedArena {
+  static_assert(is_trivially_destructible<T>::value, "objects are never destroyed one by one");
+
+  vector<unique_ptr<T[]>> chunks;
+  size_t count = 0;
+
+ public:
+  // Выделить n подряд идущих номеров, возвращает первый
+  size_t allocate(size_t n = 1) {
+    size_t first = count;
+    count += n;
+    while (chunks.size() * ChunkSize < count) chunks.emplace_back(new T[ChunkSize]);
+    return first;
+  }
+
+  T &operator[](size_t i) { return chunks[i / ChunkSize][i % ChunkSize]; }
+  const T &operator[](size_t i) const { return chunks[i / ChunkSize][i % ChunkSize]; }
+
+  [[nodiscard]] size_t size() const { return count; }
+  // Занято памяти блоками
+  [[nodiscard]] size_t bytes() const { return chunks.size() * ChunkSize * sizeof(T); }
+
+  // Освободить всё сразу
+  void clear() {
+    chunks.clear();
+    count = 0;
+  }
+};
@@ -2,14 +2,34 @@
 
 #include <cwchar>
 
+#include "arena.h"
 #include "dynamicarray.h"
+#include "parallel.h"
 #include "sequence.h"
 
-// АТД последовательность на основе динамического массива
+// Непрерывный участок массива без владения памятью (аналог std::span)
 template <class T>
+class ArraySlice {
+  const T *first;
+  int length;
+
+ public:
+  ArraySlice(const T *first, int length) : first(first), length(length) {}
+  const T *begin() const { return first; }
+  const T *end() const { return first + length; }
+  [[nodiscard]] int size() const { return length; }
+  const T &operator[](int i) const { return first[i]; }
+  // Подучасток [startIndex, endIndex] без проверки границ
+  ArraySlice slice(int startIndex, int endIndex) const { return ArraySlice(first + startIndex, endIndex - startIndex + 1); }
+};
+
+// АТД последовательность на основе динамического массива
+// Definedness, InlineCapacity, Alloc - политика учёта заданных элементов,
+// размер встроенного буфера и аллокатор (см. DynamicArray)
+template <class T, class Definedness = DefinedBits, int InlineCapacity = 0, class Alloc = allocator<T>>
 class ArraySequence : public Sequence<T> {
  private:
-  DynamicArray<T> data;  // Массив данных
+  DynamicArray<T, Definedness, InlineCapacity, Alloc> data;  // Массив данных
  public:
   // == Создание объекта ==
   // Копировать элементы из переданного массива
@@ -19,7 +39,7 @@ class ArraySequence : public Sequence<T> {
   // Создать пустой список на основе массива
   ArraySequence() : data() {};
   // Копирующий конструктор
-  explicit ArraySequence(const DynamicArray<T> &array) : data(array) {};
+  explicit ArraySequence(const DynamicArray<T, Definedness, InlineCapacity, Alloc> &array) : data(array) {};
   // == Декомпозиция ==
   // Получить первый элемент в списке
   // Может выбрасывать исключения: IndexOutOfRange (если список пуст)
@@ -44,18 +64,54 @@ class ArraySequence : public Sequence<T> {
     return data[i];  // Получаем ссылку, чтобы сделать присваивание obj[1] = 12 + 3232
   }
   // Получить список из всех элементов, начиная с startIndex и заканчивая endIndex
+  // Элементы копируются одним блоком, незаданные элементы остаются незаданными
   // Может выбрасывать исключения:
   // - IndexOutOfRange (если хотя бы один из индексов отрицательный или больше/равен числу элементов)
   Sequence<T> *getSubsequence(int startIndex, int endIndex) const override {
     if (startIndex > endIndex) {  // Проверяем корректность индексов
       throw IndexOutOfRange(string("Index startIndex <= endIndex"));
     }
-    int size = endIndex - startIndex + 1;  // Размер последовательности
-    DynamicArray<T> da(size);
-    for (int i = 0; i < size; i++) {
-      da[i] = get(startIndex + i);
+    auto *res = new ArraySequence();
+    try {
+      res->data.appendRange(data, startIndex, endIndex - startIndex + 1);
+    } catch (...) {
+      delete res;
+      throw;
     }
-    return new ArraySequence<T>(da);
+    return res;
+  }
+  // Подпоследовательность без копирования - представление поверх этого массива.
+  // Действительна, пока исходная последовательность не изменена и не удалена;
+  // при изменении самого представления его элементы копируются
+  // Может выбрасывать исключения: IndexOutOfRange (см. getSubsequence)
+  Sequence<T> *getSubsequenceView(int startIndex, int endIndex) const;
+  // Непрерывный участок элементов [startIndex, endIndex] без копирования
+  ArraySlice<T> slice(int startIndex, int endIndex) const {
+    checkRange(startIndex, endIndex);
+    return ArraySlice<T>(data.getData() + startIndex, endIndex - startIndex + 1);
+  }
+  // == Непрерывные итераторы (указатели) ==
+  // Позволяют использовать std::sort, range-for и векторизуемые циклы.
+  // Незаданные элементы видны через итераторы как значения по умолчанию.
+  // Через неконстантные итераторы можно записать любой элемент, поэтому они, как и неконстантный
+  // operator[], сначала помечают все элементы заданными (defineAll)
+  T *begin() {
+    data.defineAll();
+    return data.getData();
+  }
+  T *end() {
+    data.defineAll();
+    return data.getData() + data.getSize();
+  }
+  const T *begin() const {
+    return data.getData();
+  }
+  const T *end() const {
+    return data.getData() + data.getSize();
+  }
+  // Добавить в конец все элементы участка - одним копированием
+  void appendRange(ArraySlice<T> items) {
+    data.appendRange(items.begin(), items.size());
   }
   // Получить длину списка
   // Может выбрасывать исключения: IndexOutOfRange (если индекс отрицательный или больше/равен числу элементов)
@@ -80,7 +136,12 @@ class ArraySequence : public Sequence<T> {
   // Сцепляет два списка
   Sequence<T> *concat(Sequence<T> *list) override {
     // Сначала копируем наш массив в результат
-    auto *result = new ArraySequence<T>(this->data);
+    auto *result = new ArraySequence(this->data);
+    if (auto *array = dynamic_cast<ArraySequence *>(list)) {
+      // Второй список того же типа - копируем его массив одним блоком без виртуальных вызовов
+      result->data.appendRange(array->data, 0, array->getLength());
+      return result;
+    }
     // Общая длина = сумма длин первого и второго списка
     result->data.resize(getLength() + list->getLength());
     for (int i = 0; i < list->getLength(); i++) {
@@ -97,16 +158,16 @@ class ArraySequence : public Sequence<T> {
     data.print();
   }
   // == Виртуальный деструктор ==
-  virtual ~ArraySequence<T>() = default;
+  virtual ~ArraySequence() = default;
   Sequence<T> *map(T (*f)(T)) const override {
-    Sequence<T> *res = new ArraySequence<T>();
+    Sequence<T> *res = new ArraySequence();
     for (int i = 0; i < getLength(); i++) {
       res->append(f(data.get(i)));
     }
     return res;
   }
   Sequence<T> *where(bool (*h)(T)) const override {
-    auto *res = new ArraySequence<T>;
+    auto *res = new ArraySequence;
     for (int i = 0; i < getLength(); i++) {
       T item = data.get(i);
       if (h(item)) {  // Если h возвращает true - добавляем элемент в результат
@@ -117,9 +178,186 @@ class ArraySequence : public Sequence<T> {
   }
   T reduce(T (*f)(T, T)) const override {
     T result = data.get(0);
-    for (int i = 1; i < data.getSize(); i++) {
-      result = f(result, data.get(i));
+    if constexpr (Definedness::dense) {
+      // В плотном массиве все элементы заданы - проверки в цикле не нужны
+      const T *items = data.getData();
+      for (int i = 1; i < data.getSize(); i++) {
+        result = f(result, items[i]);
+      }
+    } else {
+      for (int i = 1; i < data.getSize(); i++) {
+        result = f(result, data.get(i));
+      }
+    }
+    return result;
+  }
+  // == Параллельные версии map, where и reduce ==
+  // Для последовательностей короче threshold работа выполняется одним куском в вызывающем потоке.
+  // Функции могут вызываться из разных потоков одновременно
+  template <class F>
+  Sequence<T> *mapParallel(F f, int threshold = PARALLEL_THRESHOLD) const {
+    int n = getLength();
+    auto *res = new ArraySequence(n);
+    runChunks(n, chunksFor(n, threshold), [&](int, int begin, int end) {
+      for (int i = begin; i < end; i++) res->data.getUnchecked(i) = f(data.get(i));
+    });
+    res->data.defineAll();
+    return res;
+  }
+  // Двухпроходный where: сначала каждый кусок считает подходящие элементы,
+  // затем по префиксным суммам пишет их в свою часть результата - порядок сохраняется без блокировок
+  template <class H>
+  Sequence<T> *whereParallel(H h, int threshold = PARALLEL_THRESHOLD) const {
+    int n = getLength();
+    int chunks = chunksFor(n, threshold);
+    vector<char> keep(n);
+    vector<int> offset(chunks + 1, 0);
+    runChunks(n, chunks, [&](int chunk, int begin, int end) {
+      int count = 0;
+      for (int i = begin; i < end; i++) count += keep[i] = h(data.get(i)) ? 1 : 0;
+      offset[chunk + 1] = count;
+    });
+    for (int c = 0; c < chunks; c++) offset[c + 1] += offset[c];
+    auto *res = new ArraySequence(offset[chunks]);
+    runChunks(n, chunks, [&](int chunk, int begin, int end) {
+      int pos = offset[chunk];
+      for (int i = begin; i < end; i++) {
+        if (keep[i]) res->data.getUnchecked(pos++) = data.get(i);
+      }
+    });
+    res->data.defineAll();
+    return res;
+  }
+  // Древовидная свёртка: куски сворачиваются параллельно, затем частичные результаты
+  // объединяются попарно. Порядок операндов сохраняется, поэтому f должна быть только ассоциативной
+  // Может выбрасывать исключения: IndexOutOfRange (если последовательность пуста)
+  template <class F>
+  T reduceParallel(F f, int threshold = PARALLEL_THRESHOLD) const {
+    int n = getLength();
+    int chunks = chunksFor(n, threshold);
+    vector<T> partial(chunks);
+    runChunks(n, chunks, [&](int chunk, int begin, int end) {
+      T result = data.get(begin);
+      for (int i = begin + 1; i < end; i++) result = f(result, data.get(i));
+      partial[chunk] = result;
+    });
+    for (int step = 1; step < chunks; step *= 2) {
+      for (int i = 0; i + step < chunks; i += 2 * step) partial[i] = f(partial[i], partial[i + step]);
+    }
+    return partial[0];
+  }
+
+ private:
+  // Проверка диапазона индексов [startIndex, endIndex]
+  void checkRange(int startIndex, int endIndex) const {
+    if (startIndex > endIndex) {
+      throw IndexOutOfRange(string("Index startIndex <= endIndex"));
+    }
+    if (startIndex < 0 || endIndex >= getLength()) {
+      throw IndexOutOfRange(string("Range ") + to_string(startIndex) + ".." + to_string(endIndex) + " out of range 0.." +
+                            to_string(getLength() - 1));
+    }
+  }
+  // Количество кусков: один для коротких последовательностей
+  static int chunksFor(int n, int threshold) {
+    return n < threshold ? 1 : ThreadPool::global().chunksFor(n);
+  }
+  // Выполнение body(chunk, begin, end) для кусков [0, n): один кусок - в вызывающем потоке
+  template <class Body>
+  static void runChunks(int n, int chunks, Body body) {
+    if (chunks == 1)
+      body(0, 0, n);
+    else
+      ThreadPool::global().parallelFor(n, chunks, body);
+  }
+};
+
+// Подпоследовательность-представление: ссылается на элементы другой последовательности без копирования.
+// Чтение идёт напрямую из исходного массива, любое изменение сначала копирует элементы
+// в собственный массив (копирование при записи)
+template <class T, class Source>
+class SequenceSlice : public Sequence<T> {
+  const Source *source;      // Исходная последовательность
+  int start;                 // Индекс первого элемента в исходной последовательности
+  int length;                // Количество элементов
+  ArraySequence<T> *owned = nullptr;  // Собственная копия после первого изменения
+
+  // Получить собственную копию для изменения
+  ArraySequence<T> &materialize() {
+    if (owned == nullptr) {
+      owned = new ArraySequence<T>();
+      for (int i = 0; i < length; i++) owned->append(source->Source::get(start + i));
+    }
+    return *owned;
+  }
+
+ public:
+  SequenceSlice(const Source *source, int start, int length) : source(source), start(start), length(length) {}
+  SequenceSlice(const SequenceSlice &) = delete;
+  SequenceSlice &operator=(const SequenceSlice &) = delete;
+  ~SequenceSlice() override { delete owned; }
+
+  T getFirst() const override { return get(0); }
+  T getLast() const override { return get(getLength() - 1); }
+  T get(int index) const override {
+    if (owned != nullptr) return owned->get(index);
+    if (index < 0 || index >= length) {
+      throw IndexOutOfRange(string("Index ") + to_string(index) + " out of range 0.." + to_string(length - 1));
+    }
+    return source->Source::get(start + index);  // Вызов без виртуальной диспетчеризации
+  }
+  T operator[](int i) const override { return get(i); }
+  T &operator[](int i) override { return materialize()[i]; }
+  Sequence<T> *getSubsequence(int startIndex, int endIndex) const override {
+    if (owned != nullptr) return owned->getSubsequence(startIndex, endIndex);
+    if (startIndex > endIndex || startIndex < 0 || endIndex >= length) {
+      throw IndexOutOfRange(string("Index startIndex <= endIndex"));
+    }
+    return source->getSubsequence(start + startIndex, start + endIndex);
+  }
+  [[nodiscard]] int getLength() const override { return owned != nullptr ? owned->getLength() : length; }
+  void append(T item) override { materialize().append(item); }
+  void prepend(T item) override { materialize().prepend(item); }
+  void insertAt(T item, int index) override { materialize().insertAt(item, index); }
+  void removeAt(int index) override { materialize().removeAt(index); }
+  Sequence<T> *concat(Sequence<T> *list) override { return materialize().concat(list); }
+  void print() override {
+    wcout << L"SequenceSlice size = " << getLength() << L":";
+    for (int i = 0; i < getLength(); i++) wcout << L" " << get(i);
+    wcout << endl;
+  }
+  Sequence<T> *map(T (*f)(T)) const override {
+    auto *res = new ArraySequence<T>();
+    for (int i = 0; i < getLength(); i++) res->append(f(get(i)));
+    return res;
+  }
+  Sequence<T> *where(bool (*h)(T)) const override {
+    auto *res = new ArraySequence<T>();
+    for (int i = 0; i < getLength(); i++) {
+      T item = get(i);
+      if (h(item)) res->append(item);
     }
+    return res;
+  }
+  T reduce(T (*f)(T, T)) const override {
+    T result = get(0);
+    for (int i = 1; i < getLength(); i++) result = f(result, get(i));
     return result;
   }
 };
+
+template <class T, class Definedness, int InlineCapacity, class Alloc>
+Sequence<T> *ArraySequence<T, Definedness, InlineCapacity, Alloc>::getSubsequenceView(int startIndex,
+                                                                                    int endIndex) const {
+  checkRange(startIndex, endIndex);
+  return new SequenceSlice<T, ArraySequence>(this, startIndex, endIndex - startIndex + 1);
+}
+
+// Плотная последовательность: все элементы всегда заданы, без битовой маски и проверок
+template <class T>
+using DenseArraySequence = ArraySequence<T, AllDefined>;
+
+// Короткая последовательность: до 16 элементов хранятся в самом объекте,
+// более длинные - в арене текущего потока
+template <class T>
+using SmallArraySequence = ArraySequence<T, DefinedBits, 16, ArenaAllocator<T>>;
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "backpack.h"
+#include "solver.h"
+
+using namespace std;
+
+// Перебор BacktrackSolver в отдельном потоке. Вызывающий поток может опрашивать готовность (poll)
+// и ход перебора (progress), получать сообщения о ходе перебора (callback вызывается в потоке перебора)
+// и отменить перебор (cancel) - тогда get возвращает решения, найденные до остановки.
+// Предметы должны жить до окончания перебора
+class AsyncSolve {
+ public:
+  using ProgressCallback = function<void(const SolveProgress &)>;
+
+  AsyncSolve(const BackPack &bp, const vector<Item *> &items, SolverOptions options = {}, ProgressCallback callback = {},
+             chrono::milliseconds interval = chrono::milliseconds(100))
+      : solver(make_unique<BacktrackSolver>(bp, options)), callback(std::move(callback)) {
+    solver->reportProgress([this](const SolveProgress &p) { update(p); }, interval);
+    worker = thread([this, items]() {
+      try {
+        auto res = solver->solve(items);
+        lock_guard<mutex> lock(m);
+        solutions = std::move(res);
+      } catch (...) {
+        lock_guard<mutex> lock(m);
+        error = current_exception();
+      }
+      lock_guard<mutex> lock(m);
+      finished = true;
+    });
+  }
+  AsyncSolve(const AsyncSolve &) = delete;
+  AsyncSolve &operator=(const AsyncSolve &) = delete;
+  // Незавершённый перебор отменяется
+  ~AsyncSolve() {
+    cancel();
+    if (worker.joinable()) worker.join();
+  }
+
+  // Завершён ли перебор (полностью или после отмены)
+  [[nodiscard]] bool poll() const {
+    lock_guard<mutex> lock(m);
+    return finished;
+  }
+  // Последнее известное состояние перебора
+  [[nodiscard]] SolveProgress progress() const {
+    lock_guard<mutex> lock(m);
+    return last;
+  }
+  // Попросить перебор остановиться (не ждёт остановки)
+  void cancel() { solver->cancel(); }
+
+  // Дождаться окончания и забрать решения (повторный вызов вернёт пустое множество).
+  // Исключение из потока перебора выбрасывается здесь
+  set<BackPack> get() {
+    if (worker.joinable()) worker.join();
+    if (error) rethrow_exception(error);
+    return std::move(solutions);
+  }
+  // Был ли перебор остановлен до завершения; имеет смысл после get
+  [[nodiscard]] bool stopped() const { return solver->stopped(); }
+
+ private:
+  unique_ptr<BacktrackSolver> solver;
+  ProgressCallback callback;
+  mutable mutex m;
+  SolveProgress last;
+  bool finished = false;
+  set<BackPack> solutions;
+  exception_ptr error;
+  thread worker;
+
+  void update(const SolveProgress &p) {
+    {
+      lock_guard<mutex> lock(m);
+      last = p;
+    }
+    if (callback) callback(p);
+  }
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <random>
@@ -55,10 +56,22 @@ struct BackPack {
   vector<string> shape;  // Форма рюкзака
   int weight = 0;        // Вес
   int price = 0;         // Стоимость
+  int freeCells = 0;     // Количество свободных клеток '_' (незаполненный объём ΔV)
 
   BackPack() : shape(), weight(0), price(0) {}
 
-  BackPack(const vector<string> &shape, int weight, int price) : shape(shape), weight(weight), price(price) {}
+  BackPack(const vector<string> &shape, int weight, int price) : shape(shape), weight(weight), price(price) {
+    countFreeCells();
+  }
+  // Решатель знает количество свободных клеток и не пересчитывает его
+  BackPack(const vector<string> &shape, int weight, int price, int freeCells)
+      : shape(shape), weight(weight), price(price), freeCells(freeCells) {}
+
+  // Пересчитать свободные клетки по изображению (после того как shape заполнен вручную)
+  void countFreeCells() {
+    freeCells = 0;
+    for (auto &row : shape) freeCells += count(row.begin(), row.end(), '_');
+  }
 
   ~BackPack() = default;
 
@@ -175,6 +188,70 @@ bool tryPutItem(const vector<string> &item, vector<string> &bp, int rowOffset, i
   return true;  // Удалось разместить
 }
 
+// Группа одинаковых предметов: совпадают вес, стоимость и форма с точностью до поворотов и отражений
+struct ItemGroup {
+  const Item *item;     // Представитель группы
+  vector<int> indices;  // Номера всех копий в исходном списке, по возрастанию
+  [[nodiscard]] int count() const { return indices.size(); }
+};
+
+// Разбиение списка предметов на группы одинаковых. Ключ группы - канонический поворот
+// (наименьший из genAllRotations), вес и стоимость. Группы идут в порядке первых копий
+vector<ItemGroup> groupIdentical(const vector<Item *> &items) {
+  vector<ItemGroup> groups;
+  vector<Shape> canonical;
+  for (int i = 0; i < items.size(); i++) {
+    Shape shape = *genAllRotations(items[i]->shape).begin();
+    int g = 0;
+    while (g < groups.size() && !(groups[g].item->weight == items[i]->weight &&
+                                  groups[g].item->price == items[i]->price && canonical[g] == shape))
+      g++;
+    if (g == groups.size()) {
+      groups.push_back({items[i], {}});
+      canonical.push_back(shape);
+    }
+    groups[g].indices.push_back(i);
+  }
+  return groups;
+}
+
+// Хэш FNV-1a (64 бита): отпечаток задачи для контрольных точек и кэша результатов
+struct Fnv1a {
+  uint64_t value = 14695981039346656037ULL;
+
+  void add(const void *data, size_t size) {
+    auto *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++) {
+      value ^= bytes[i];
+      value *= 1099511628211ULL;
+    }
+  }
+  void add(long long x) { add(&x, sizeof(x)); }
+  void add(const string &s) {
+    add((long long)s.size());
+    add(s.data(), s.size());
+  }
+  void add(const vector<string> &shape) {
+    add((long long)shape.size());
+    for (auto &row : shape) add(row);
+  }
+};
+
+// Отпечаток задачи: рюкзак и предметы в порядке списка
+uint64_t instanceHash(const BackPack &bp, const vector<Item *> &items) {
+  Fnv1a h;
+  h.add(bp.shape);
+  h.add(bp.weight);
+  h.add(bp.price);
+  h.add((long long)items.size());
+  for (auto *item : items) {
+    h.add(item->weight);
+    h.add(item->price);
+    h.add(item->shape);
+  }
+  return h.value;
+}
+
 class BackPackSearch {
  public:
   BackPack bp;
@@ -182,6 +259,80 @@ class BackPackSearch {
   BackPackSearch(const BackPack &backPack, bool leaf) : bp(backPack), leaf(leaf) {}
 };
 
+// Индекс найденных решений (листьев дерева решений) по стоимости и по весу.
+// Решения хранятся в плоском массиве, отсортированном по (стоимость, вес),
+// плюс массив номеров решений, отсортированный по (вес, стоимость).
+// Точный поиск, поиск по диапазону и первые k - за O(log n + k)
+class SolutionIndex {
+  vector<BackPack> byPrice;  // Решения по возрастанию стоимости (при равной - по весу)
+  vector<int> byWeight;      // Номера решений в byPrice по возрастанию веса
+
+  // Первая позиция в byPrice со стоимостью >= price
+  int priceLowerBound(int price) const {
+    return int(partition_point(byPrice.begin(), byPrice.end(), [price](const BackPack &b) { return b.price < price; }) -
+               byPrice.begin());
+  }
+  // Первая позиция в byWeight с весом >= weight
+  int weightLowerBound(int weight) const {
+    return int(partition_point(byWeight.begin(), byWeight.end(),
+                               [this, weight](int i) { return byPrice[i].weight < weight; }) -
+               byWeight.begin());
+  }
+
+ public:
+  SolutionIndex() = default;
+  explicit SolutionIndex(const set<BackPack> &solutions) { build(solutions); }
+
+  // Перестроить индекс по множеству решений - O(n log n)
+  void build(const set<BackPack> &solutions) {
+    // set уже упорядочен по (стоимость, вес)
+    byPrice.assign(solutions.begin(), solutions.end());
+    byWeight.resize(byPrice.size());
+    for (int i = 0; i < byWeight.size(); i++) byWeight[i] = i;
+    stable_sort(byWeight.begin(), byWeight.end(), [this](int a, int b) {
+      if (byPrice[a].weight == byPrice[b].weight) return byPrice[a].price < byPrice[b].price;
+      return byPrice[a].weight < byPrice[b].weight;
+    });
+  }
+
+  [[nodiscard]] int size() const { return byPrice.size(); }
+  [[nodiscard]] bool empty() const { return byPrice.empty(); }
+
+  // Все решения со стоимостью в диапазоне [minPrice, maxPrice] по возрастанию стоимости
+  vector<const BackPack *> priceRange(int minPrice, int maxPrice) const {
+    vector<const BackPack *> res;
+    for (int i = priceLowerBound(minPrice); i < byPrice.size() && byPrice[i].price <= maxPrice; i++) {
+      res.push_back(&byPrice[i]);
+    }
+    return res;
+  }
+  // Все решения с заданной стоимостью
+  vector<const BackPack *> findPrice(int price) const { return priceRange(price, price); }
+  // k самых дорогих решений (по убыванию стоимости)
+  vector<const BackPack *> topByPrice(int k) const {
+    vector<const BackPack *> res;
+    for (int i = int(byPrice.size()) - 1; i >= 0 && res.size() < k; i--) res.push_back(&byPrice[i]);
+    return res;
+  }
+
+  // Все решения с весом в диапазоне [minWeight, maxWeight] по возрастанию веса
+  vector<const BackPack *> weightRange(int minWeight, int maxWeight) const {
+    vector<const BackPack *> res;
+    for (int i = weightLowerBound(minWeight); i < byWeight.size() && byPrice[byWeight[i]].weight <= maxWeight; i++) {
+      res.push_back(&byPrice[byWeight[i]]);
+    }
+    return res;
+  }
+  // Все решения с заданным весом
+  vector<const BackPack *> findWeight(int weight) const { return weightRange(weight, weight); }
+  // k самых лёгких решений (по возрастанию веса)
+  vector<const BackPack *> lightest(int k) const {
+    vector<const BackPack *> res;
+    for (int i = 0; i < byWeight.size() && res.size() < k; i++) res.push_back(&byPrice[byWeight[i]]);
+    return res;
+  }
+};
+
 // Дерево решений
 class SolutionTree {
  public:
@@ -234,6 +385,8 @@ class SolutionTree {
         }
 
         set<Shape> shapes = genAllRotations(items[i]->shape);
+        int cells = 0;  // Клеток занимает предмет (одинаково для всех поворотов)
+        for (auto &row : items[i]->shape) cells += count(row.begin(), row.end(), '@');
         for (auto &shape : shapes) {
           for (int row = 0; row < bp.shape.size(); row++) {
             for (int col = 0; col < bp.shape[row].size(); col++) {
@@ -242,7 +395,7 @@ class SolutionTree {
               // Пробуем положить фигуру начиная с клетки рюкзака row col
               vector<string> newBP(bp.shape);  // Копируем изображение
               if (tryPutItem(shape, newBP, row, col, char('1' + i))) {
-                BackPack nbp = BackPack(newBP, bp.weight + items[i]->weight, bp.price + items[i]->price);
+                BackPack nbp(newBP, bp.weight + items[i]->weight, bp.price + items[i]->price, bp.freeCells - cells);
 
                 Node *chd = new Node(nbp, this, keys, i, solutions, items);
                 child.emplace_back(chd);
@@ -257,42 +410,55 @@ class SolutionTree {
       }
     }
 
-    vector<BackPackSearch> search(int price) {
-      vector<BackPackSearch> res;
+    // Результаты накапливаются в res, чтобы не копировать вектор на каждом уровне.
+    // Дети не упорядочены по стоимости, но стоимость вдоль пути только растёт,
+    // поэтому отсекаем только поддеревья, корень которых уже дороже price
+    void search(int price, vector<BackPackSearch> &res) const {
       for (auto node : child) {
-        // Если найденный ключ равен k, возвращаем этот узел
+        if (node->bp.price > price) continue;
+        // Если найденный ключ равен k, добавляем этот узел
         if (node->bp.price == price) res.emplace_back(BackPackSearch(node->bp, node->leaf));
-        if (node->bp.price > price) break;
-        auto childRes = node->search(price);
-        res.insert(std::end(res), std::begin(childRes), std::end(childRes));
+        node->search(price, res);
       }
-      return res;
     }
   };
 
  public:
-  Node *root;
+  Node *root = nullptr;
+  SolutionIndex index;  // Индекс найденных решений по стоимости и весу
 
   explicit SolutionTree(const BackPack &bp) : backPack(bp) {}
 
   set<BackPack> solve(const vector<Item *> &items) {
     set<BackPack> solutions;
+    delete root;
     root = new Node(backPack, solutions, items);
+    index.build(solutions);
     return solutions;
   }
 
   ~SolutionTree() { delete root; }
 
+  // Поиск всех узлов дерева (в том числе промежуточных) с заданной стоимостью.
+  // Для запросов только по найденным решениям используйте index - он не обходит дерево
   vector<BackPackSearch> search(int price) const {
+    vector<BackPackSearch> res;
     if (root) {
-      return root->search(price);
+      root->search(price, res);
     }
-    return vector<BackPackSearch>();
+    return res;
   }
 };
 
 /// Чтение рюкзака и предметов из файла
 class Config {
+  // Чтение строки без завершающего '\r' (файлы могут быть сохранены с окончаниями строк CRLF)
+  static istream &readLine(istream &input, string &s) {
+    getline(input, s);
+    if (!s.empty() && s.back() == '\r') s.pop_back();
+    return input;
+  }
+
  public:
   BackPack backPack;
   vector<Item *> items;
@@ -308,23 +474,24 @@ class Config {
     // Считываем рюкзак
     string s;
     input >> maxWeight;
-    getline(input, s);  // Skip "end of line"
-    getline(input, s);
+    readLine(input, s);  // Skip "end of line"
+    readLine(input, s);
     while (!s.empty()) {
       backPack.shape.push_back(s);
-      getline(input, s);
+      readLine(input, s);
     }
+    backPack.countFreeCells();
     // Считываем предметы для укладки
     int weight, price;
     while (input >> weight >> price) {  // Пока не кончился файл
       Item *item = new Item(weight, price);
       item->weight = weight;
       item->price = price;
-      getline(input, s);
-      getline(input, s);           // Считываем очередную строку рисунка фигуры
+      readLine(input, s);
+      readLine(input, s);          // Считываем очередную строку рисунка фигуры
       while (!s.empty()) {         // Если она не пустая
         item->shape.push_back(s);  // Добавляем в образ фигуры
-        getline(input, s);         // И читаем следующую строчку
+        readLine(input, s);        // И читаем следующую строчку
       }
       items.emplace_back(item);  // Добавляем
       // wcout << *item << endl; // Вывод для отладки
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 using namespace std;
 
 template <typename T>
@@ -24,6 +27,12 @@ class BTreeNode {
     n = 0;
   }
 
+  // Деструктор освобождает только массивы узла, дети удаляются деревом
+  ~BTreeNode() {
+    delete[] keys;
+    delete[] C;
+  }
+
   // Вставка нового ключа в неполное поддерево этого узла
   void insertNonFull(T k);
 
@@ -36,6 +45,32 @@ class BTreeNode {
 // Функция для поиска ключа в поддереве узла. NULL, если k отсутствует
   BTreeNode *search(T k);
 
+  // Индекс первого ключа >= k
+  int findKey(const T &k) const;
+
+  // Удаление ключа k из поддерева этого узла. false, если ключа нет
+  bool remove(const T &k);
+
+  // Удаление idx-го ключа из листа
+  void removeFromLeaf(int idx);
+
+  // Удаление idx-го ключа из внутреннего узла
+  bool removeFromNonLeaf(int idx);
+
+  // Предшественник и преемник idx-го ключа
+  T getPred(int idx);
+  T getSucc(int idx);
+
+  // Дополнение ребенка C[idx], у которого меньше t ключей
+  void fill(int idx);
+
+  // Заимствование ключа у соседей ребенка C[idx]
+  void borrowFromPrev(int idx);
+  void borrowFromNext(int idx);
+
+  // Слияние C[idx] и C[idx+1]
+  void merge(int idx);
+
   friend class BTree<T>;
 };
 
@@ -44,13 +79,125 @@ template <typename T>
 class BTree {
   BTreeNode<T> *root;  // указатель на корень
   int t;
+
+  // Удаление поддерева
+  static void destroy(BTreeNode<T> *x) {
+    if (x == nullptr) return;
+    if (!x->leaf) {
+      for (int i = 0; i <= x->n; i++) destroy(x->C[i]);
+    }
+    delete x;
+  }
+
  public:
+  // Двунаправленный итератор по ключам в порядке возрастания.
+  // Хранит путь от корня: для предков - номер ребенка, в который спустились,
+  // для последнего узла - номер текущего ключа. Пустой путь - end()
+  class iterator {
+    const BTree<T> *tree = nullptr;
+    vector<pair<BTreeNode<T> *, int>> path;
+
+    // Спуск к самому левому ключу поддерева x
+    void pushLeftmost(BTreeNode<T> *x) {
+      while (true) {
+        path.emplace_back(x, 0);
+        if (x->leaf) return;
+        x = x->C[0];
+      }
+    }
+    // Спуск к самому правому ключу поддерева x
+    void pushRightmost(BTreeNode<T> *x) {
+      while (!x->leaf) {
+        path.emplace_back(x, x->n);
+        x = x->C[x->n];
+      }
+      path.emplace_back(x, x->n - 1);
+    }
+    // Подъём к первому предку, у которого ещё есть ключ справа от пройденного ребенка
+    void climbRight() {
+      path.pop_back();
+      while (!path.empty() && path.back().second == path.back().first->n) path.pop_back();
+    }
+
+    friend class BTree<T>;
+
+   public:
+    using iterator_category = bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+
+    iterator() = default;
+    explicit iterator(const BTree<T> *tree) : tree(tree) {}
+
+    const T &operator*() const { return path.back().first->keys[path.back().second]; }
+    const T *operator->() const { return &**this; }
+
+    iterator &operator++() {
+      auto &[x, i] = path.back();
+      if (!x->leaf) {
+        // Следующий ключ - самый левый в правом поддереве
+        i++;
+        pushLeftmost(x->C[i]);
+      } else if (++i == x->n) {
+        climbRight();
+      }
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator res = *this;
+      ++*this;
+      return res;
+    }
+
+    iterator &operator--() {
+      if (path.empty()) {  // --end() - самый большой ключ
+        pushRightmost(tree->root);
+        return *this;
+      }
+      auto &[x, i] = path.back();
+      if (!x->leaf) {
+        // Предыдущий ключ - самый правый в левом поддереве
+        pushRightmost(x->C[i]);
+      } else if (--i < 0) {
+        path.pop_back();
+        while (path.back().second == 0) path.pop_back();
+        path.back().second--;
+      }
+      return *this;
+    }
+    iterator operator--(int) {
+      iterator res = *this;
+      --*this;
+      return res;
+    }
+
+    friend bool operator==(const iterator &a, const iterator &b) {
+      if (a.path.empty() || b.path.empty()) return a.path.empty() == b.path.empty();
+      return a.path.back() == b.path.back();
+    }
+    friend bool operator!=(const iterator &a, const iterator &b) { return !(a == b); }
+  };
+
   // Конструктор
   BTree(int _t) {
     root = nullptr;
     t = _t;
   }
 
+  BTree(const BTree &) = delete;
+  BTree &operator=(const BTree &) = delete;
+
+  // Деструктор - освобождает все узлы
+  ~BTree() { destroy(root); }
+
+  // Удалить все ключи
+  void clear() {
+    destroy(root);
+    root = nullptr;
+  }
+
   // Обход дерева для вывода или какой-то операции
   void traverse() {
     if (root != nullptr) root->traverse();
@@ -68,6 +215,50 @@ class BTree {
 
   // Вставка ключа
   void insert(T k);
+
+  // Удаление ключа (одного экземпляра). false, если ключа нет
+  bool remove(const T &k);
+
+  // Построение дерева из отсортированной последовательности за O(n) снизу вверх.
+  // Узлы заполняются почти полностью (по 2t-1 ключей, остаток распределяется поровну).
+  // Старое содержимое дерева удаляется
+  template <class It>
+  void bulkLoad(It first, It last);
+
+  // Итераторы
+  iterator begin() const {
+    iterator it(this);
+    if (root != nullptr && root->n > 0) it.pushLeftmost(root);
+    return it;
+  }
+  iterator end() const { return iterator(this); }
+
+  // Первый ключ >= k
+  iterator lower_bound(const T &k) const {
+    return bound(k, [](const T &key, const T &k) { return key < k; });
+  }
+  // Первый ключ > k
+  iterator upper_bound(const T &k) const {
+    return bound(k, [](const T &key, const T &k) { return !(k < key); });
+  }
+
+ private:
+  // Спуск к первому ключу, для которого before(key, k) ложно
+  template <class Before>
+  iterator bound(const T &k, Before before) const {
+    iterator it(this);
+    BTreeNode<T> *x = root;
+    if (x == nullptr || x->n == 0) return it;
+    while (true) {
+      int i = 0;
+      while (i < x->n && before(x->keys[i], k)) i++;
+      it.path.emplace_back(x, i);
+      if (x->leaf) break;
+      x = x->C[i];
+    }
+    if (it.path.back().second == it.path.back().first->n) it.climbRight();
+    return it;
+  }
 };
 
 // Функция для обхода всех узлов поддерева, корни которого находятся в этом узле
@@ -88,7 +279,7 @@ BTreeNode<T> *BTreeNode<T>::search(T k) {
   int i = 0;
   while (i < n && k > keys[i]) i++;
   // Если найденный ключ равен k, возвращаем этот узел
-  if (keys[i] == k) return this;
+  if (i < n && keys[i] == k) return this;
   if (leaf) return nullptr;
   return C[i]->search(k);
 }
@@ -161,4 +352,193 @@ void BTreeNode<T>::splitChild(int i, BTreeNode<T> *y) {
   for (int j = n - 1; j >= i; j--) keys[j + 1] = keys[j];
   keys[i] = y->keys[t - 1];
   n = n + 1;
+}
+
+// Индекс первого ключа >= k
+template <typename T>
+int BTreeNode<T>::findKey(const T &k) const {
+  int idx = 0;
+  while (idx < n && keys[idx] < k) ++idx;
+  return idx;
+}
+
+// Удаление ключа k из поддерева этого узла
+template <typename T>
+bool BTreeNode<T>::remove(const T &k) {
+  int idx = findKey(k);
+  // Ключ находится в этом узле
+  if (idx < n && keys[idx] == k) {
+    if (leaf) {
+      removeFromLeaf(idx);
+      return true;
+    }
+    return removeFromNonLeaf(idx);
+  }
+  if (leaf) return false;  // Ключа в дереве нет
+  // Был ли ключ бы в последнем ребенке (он может слиться с предыдущим)
+  bool last = idx == n;
+  // Перед спуском ребенок должен содержать не меньше t ключей
+  if (C[idx]->n < t) fill(idx);
+  if (last && idx > n) return C[idx - 1]->remove(k);
+  return C[idx]->remove(k);
+}
+
+// Удаление idx-го ключа из листа
+template <typename T>
+void BTreeNode<T>::removeFromLeaf(int idx) {
+  for (int i = idx + 1; i < n; ++i) keys[i - 1] = keys[i];
+  n--;
+}
+
+// Удаление idx-го ключа из внутреннего узла
+template <typename T>
+bool BTreeNode<T>::removeFromNonLeaf(int idx) {
+  T k = keys[idx];
+  if (C[idx]->n >= t) {
+    // Заменяем ключ предшественником и удаляем предшественника из левого поддерева
+    T pred = getPred(idx);
+    keys[idx] = pred;
+    return C[idx]->remove(pred);
+  }
+  if (C[idx + 1]->n >= t) {
+    // Заменяем ключ преемником и удаляем преемника из правого поддерева
+    T succ = getSucc(idx);
+    keys[idx] = succ;
+    return C[idx + 1]->remove(succ);
+  }
+  // Оба ребенка минимальны - сливаем их вместе с ключом и удаляем из результата
+  merge(idx);
+  return C[idx]->remove(k);
+}
+
+// Предшественник - самый правый ключ левого поддерева
+template <typename T>
+T BTreeNode<T>::getPred(int idx) {
+  BTreeNode<T> *cur = C[idx];
+  while (!cur->leaf) cur = cur->C[cur->n];
+  return cur->keys[cur->n - 1];
+}
+
+// Преемник - самый левый ключ правого поддерева
+template <typename T>
+T BTreeNode<T>::getSucc(int idx) {
+  BTreeNode<T> *cur = C[idx + 1];
+  while (!cur->leaf) cur = cur->C[0];
+  return cur->keys[0];
+}
+
+// Дополнение ребенка C[idx] до t ключей: заимствование у соседа или слияние
+template <typename T>
+void BTreeNode<T>::fill(int idx) {
+  if (idx != 0 && C[idx - 1]->n >= t)
+    borrowFromPrev(idx);
+  else if (idx != n && C[idx + 1]->n >= t)
+    borrowFromNext(idx);
+  else if (idx != n)
+    merge(idx);
+  else
+    merge(idx - 1);
+}
+
+// Перенос ключа из C[idx-1] через родителя в C[idx]
+template <typename T>
+void BTreeNode<T>::borrowFromPrev(int idx) {
+  BTreeNode<T> *child = C[idx];
+  BTreeNode<T> *sibling = C[idx - 1];
+  for (int i = child->n - 1; i >= 0; --i) child->keys[i + 1] = child->keys[i];
+  if (!child->leaf) {
+    for (int i = child->n; i >= 0; --i) child->C[i + 1] = child->C[i];
+  }
+  child->keys[0] = keys[idx - 1];
+  if (!child->leaf) child->C[0] = sibling->C[sibling->n];
+  keys[idx - 1] = sibling->keys[sibling->n - 1];
+  child->n += 1;
+  sibling->n -= 1;
+}
+
+// Перенос ключа из C[idx+1] через родителя в C[idx]
+template <typename T>
+void BTreeNode<T>::borrowFromNext(int idx) {
+  BTreeNode<T> *child = C[idx];
+  BTreeNode<T> *sibling = C[idx + 1];
+  child->keys[child->n] = keys[idx];
+  if (!child->leaf) child->C[child->n + 1] = sibling->C[0];
+  keys[idx] = sibling->keys[0];
+  for (int i = 1; i < sibling->n; ++i) sibling->keys[i - 1] = sibling->keys[i];
+  if (!sibling->leaf) {
+    for (int i = 1; i <= sibling->n; ++i) sibling->C[i - 1] = sibling->C[i];
+  }
+  child->n += 1;
+  sibling->n -= 1;
+}
+
+// Слияние C[idx+1] в C[idx], ключ idx опускается в середину
+template <typename T>
+void BTreeNode<T>::merge(int idx) {
+  BTreeNode<T> *child = C[idx];
+  BTreeNode<T> *sibling = C[idx + 1];
+  child->keys[t - 1] = keys[idx];
+  for (int i = 0; i < sibling->n; ++i) child->keys[i + t] = sibling->keys[i];
+  if (!child->leaf) {
+    for (int i = 0; i <= sibling->n; ++i) child->C[i + t] = sibling->C[i];
+  }
+  for (int i = idx + 1; i < n; ++i) keys[i - 1] = keys[i];
+  for (int i = idx + 2; i <= n; ++i) C[i - 1] = C[i];
+  child->n += sibling->n + 1;
+  n--;
+  delete sibling;  // Дети sibling теперь принадлежат child
+}
+
+// Удаление ключа из дерева
+template <typename T>
+bool BTree<T>::remove(const T &k) {
+  if (root == nullptr) return false;
+  bool removed = root->remove(k);
+  // Если корень опустел, дерево уменьшается в высоту
+  if (root->n == 0) {
+    BTreeNode<T> *old = root;
+    root = root->leaf ? nullptr : root->C[0];
+    delete old;
+  }
+  return removed;
+}
+
+// Построение дерева из отсортированной последовательности снизу вверх
+template <typename T>
+template <class It>
+void BTree<T>::bulkLoad(It first, It last) {
+  vector<T> level(first, last);  // Ключи текущего уровня
+  for (int i = 1; i < level.size(); i++) {
+    if (level[i] < level[i - 1]) throw runtime_error("bulkLoad: keys are not sorted");
+  }
+  clear();
+  if (level.empty()) return;
+  vector<BTreeNode<T> *> children;  // Узлы предыдущего (нижнего) уровня
+  while (true) {
+    int K = level.size();
+    // Узел с разделителем занимает 2t ключей уровня: c узлов и c-1 разделителей
+    int c = (K + 1 + 2 * t - 1) / (2 * t);
+    int keysInNodes = K - (c - 1);
+    vector<BTreeNode<T> *> nodes;
+    vector<T> separators;
+    int pos = 0, child = 0;
+    for (int j = 0; j < c; j++) {
+      // Остаток распределяем поровну, поэтому в каждом узле >= t-1 ключей
+      int cnt = keysInNodes / c + (j < keysInNodes % c ? 1 : 0);
+      auto *x = new BTreeNode<T>(t, children.empty());
+      for (int i = 0; i < cnt; i++) x->keys[i] = level[pos++];
+      if (!x->leaf) {
+        for (int i = 0; i <= cnt; i++) x->C[i] = children[child++];
+      }
+      x->n = cnt;
+      nodes.push_back(x);
+      if (j + 1 < c) separators.push_back(level[pos++]);
+    }
+    if (c == 1) {
+      root = nodes[0];
+      return;
+    }
+    level.swap(separators);
+    children.swap(nodes);
+  }
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "backpack.h"
+
+using namespace std;
+
+// Контрольная точка перебора с возвратом: путь от корня до текущего узла (ходы на каждой глубине),
+// найденные решения и статистика. Перебор, продолженный с контрольной точки, заново кладёт
+// предметы пути и идёт дальше с тех же ходов - ветки левее пути уже пройдены
+
+// Ход: предмет, номер поворота, клетка привязки
+struct SearchMove {
+  int item, orientation, row, col;
+};
+
+// Решение вместе с номером хода первого уровня, в ветке которого оно найдено
+struct OriginSolution {
+  BackPack bp;
+  int origin;
+};
+
+struct Checkpoint {
+  uint64_t fingerprint = 0;         // Отпечаток задачи и параметров поиска
+  bool done = false;                // Перебор завершён, path пуст
+  long long explored = 0, cut = 0;  // Статистика
+  int rootMoves = 0;                // Пронумеровано ходов первого уровня
+  int allowance = 0;                // Текущий допуск потерь
+  vector<SearchMove> path;          // Ходы от корня до узла, с которого продолжать
+  vector<OriginSolution> solutions;
+};
+
+const char *const CHECKPOINT_MAGIC = "L3CHECKPOINT";
+const int CHECKPOINT_VERSION = 1;
+
+// Запись во временный файл и переименование: на диске всегда целая контрольная точка
+void writeCheckpoint(const string &fileName, const Checkpoint &cp) {
+  string tmp = fileName + ".tmp";
+  {
+    ofstream out(tmp, ios::trunc);
+    if (!out.is_open()) throw runtime_error("Can't write file " + tmp);
+    out << CHECKPOINT_MAGIC << " " << CHECKPOINT_VERSION << " " << cp.fingerprint << "\n";
+    out << cp.done << " " << cp.explored << " " << cp.cut << " " << cp.rootMoves << " " << cp.allowance << "\n";
+    out << cp.path.size() << "\n";
+    for (auto &m : cp.path) out << m.item << " " << m.orientation << " " << m.row << " " << m.col << "\n";
+    out << cp.solutions.size() << "\n";
+    for (auto &s : cp.solutions) {
+      out << s.bp.price << " " << s.bp.weight << " " << s.origin << " " << s.bp.shape.size() << "\n";
+      for (auto &row : s.bp.shape) out << row << "\n";
+    }
+    if (!out) throw runtime_error("Can't write file " + tmp);
+  }
+  if (rename(tmp.c_str(), fileName.c_str()) != 0) throw runtime_error("Can't rename " + tmp + " to " + fileName);
+}
+
+// Чтение контрольной точки. Может выбрасывать исключения: runtime_error (нет файла или неверный формат)
+Checkpoint readCheckpoint(const string &fileName) {
+  ifstream in(fileName);
+  if (!in.is_open()) throw runtime_error("Can't open file " + fileName);
+  string magic;
+  int version = 0;
+  size_t depth = 0, n = 0;
+  Checkpoint cp;
+  if (!(in >> magic >> version) || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+    throw runtime_error("File " + fileName + " is not a checkpoint");
+  if (!(in >> cp.fingerprint >> cp.done >> cp.explored >> cp.cut >> cp.rootMoves >> cp.allowance >> depth))
+    throw runtime_error("Truncated checkpoint " + fileName);
+  cp.path.resize(depth);
+  for (auto &m : cp.path) {
+    if (!(in >> m.item >> m.orientation >> m.row >> m.col)) throw runtime_error("Truncated checkpoint " + fileName);
+  }
+  if (!(in >> n)) throw runtime_error("Truncated checkpoint " + fileName);
+  for (size_t i = 0; i < n; i++) {
+    OriginSolution s{};
+    int rows = 0;
+    if (!(in >> s.bp.price >> s.bp.weight >> s.origin >> rows)) throw runtime_error("Truncated checkpoint " + fileName);
+    string line;
+    getline(in, line);
+    for (int r = 0; r < rows; r++) {
+      if (!getline(in, line)) throw runtime_error("Truncated checkpoint " + fileName);
+      s.bp.shape.push_back(line);
+    }
+    s.bp.countFreeCells();
+    cp.solutions.push_back(std::move(s));
+  }
+  return cp;
+}
+
+// Фоновая запись контрольных точек: поток перебора только отдаёт снимок, файл пишет отдельный поток.
+// Если предыдущий снимок ещё не записан, он заменяется более новым
+class CheckpointWriter {
+  string fileName;
+  mutex m;
+  condition_variable cv, written;
+  Checkpoint pending;
+  bool hasPending = false, busy = false, stopping = false;
+  thread worker;
+
+  void loop() {
+    unique_lock<mutex> lock(m);
+    while (true) {
+      cv.wait(lock, [this]() { return stopping || hasPending; });
+      if (!hasPending) return;
+      Checkpoint cp = std::move(pending);
+      hasPending = false;
+      busy = true;
+      lock.unlock();
+      try {
+        writeCheckpoint(fileName, cp);
+      } catch (runtime_error &) {
+        // Не удалось записать - попробуем со следующим снимком
+      }
+      lock.lock();
+      busy = false;
+      written.notify_all();
+    }
+  }
+
+ public:
+  explicit CheckpointWriter(string fileName) : fileName(std::move(fileName)), worker([this]() { loop(); }) {}
+  CheckpointWriter(const CheckpointWriter &) = delete;
+  CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+  ~CheckpointWriter() {
+    {
+      lock_guard<mutex> lock(m);
+      stopping = true;
+    }
+    cv.notify_all();
+    worker.join();  // Последний снимок записывается до выхода
+  }
+
+  // Отдать снимок на запись (не ждёт записи)
+  void post(Checkpoint cp) {
+    {
+      lock_guard<mutex> lock(m);
+      pending = std::move(cp);
+      hasPending = true;
+    }
+    cv.notify_all();
+  }
+  // Дождаться записи всех отданных снимков
+  void flush() {
+    unique_lock<mutex> lock(m);
+    written.wait(lock, [this]() { return !hasPending && !busy; });
+  }
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "backpack.h"
+
+using namespace std;
+
+// Дерево решений SolutionTree в компактном виде - для случаев, когда дерево нужно сохранить
+// (поиск узлов по стоимости). Узел занимает 32 байта и не хранит изображение рюкзака:
+// положенные предметы - битовая маска, дети - подряд идущие номера в арене,
+// а от родителя узел отличается одной укладкой (предмет, поворот, клетка привязки).
+// Изображение восстанавливается по пути от корня, когда оно нужно (node, search).
+// Узлы выделяются из ChunkedArena и освобождаются все сразу.
+// Порядок обхода, решения и результаты search те же, что у SolutionTree
+class CompactSolutionTree {
+  struct Node {
+    uint64_t used;        // Положенные предметы: бит i - предмет i
+    uint32_t parent;      // Номер родителя (NONE у корня)
+    uint32_t firstChild;  // Дети - номера firstChild..firstChild + childCount - 1
+    uint32_t childCount;  // 0 - лист
+    int32_t weight, price;
+    uint8_t item, orientation, row, col;  // Укладка, которой узел отличается от родителя
+  };
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  // Ход: предмет, поворот, клетка привязки
+  struct Move {
+    int item, orientation, row, col;
+  };
+
+ public:
+  BackPack backPack;
+  SolutionIndex index;  // Индекс найденных решений по стоимости и весу
+
+  static constexpr size_t nodeBytes = sizeof(Node);
+
+  explicit CompactSolutionTree(const BackPack &bp) : backPack(bp) {}
+
+  // Может выбрасывать исключения: runtime_error (больше 64 предметов или рюкзак больше 256x256)
+  set<BackPack> solve(const vector<Item *> &source) {
+    if (source.size() > 64) throw runtime_error("Too many items for a compact tree");
+    if (backPack.shape.size() > 256) throw runtime_error("Backpack is too large for a compact tree");
+    for (auto &row : backPack.shape) {
+      if (row.size() > 256) throw runtime_error("Backpack is too large for a compact tree");
+    }
+    items = source;
+    shapes.assign(items.size(), {});
+    cells.assign(items.size(), 0);
+    for (int i = 0; i < items.size(); i++) {
+      for (auto &shape : genAllRotations(items[i]->shape)) shapes[i].push_back(shape);
+      for (auto &row : items[i]->shape) cells[i] += count(row.begin(), row.end(), '@');
+    }
+    all = items.size() == 64 ? ~uint64_t(0) : (uint64_t(1) << items.size()) - 1;
+    nodes.clear();
+    nodes.allocate();
+    nodes[0] = Node{0, NONE, 0, 0, backPack.weight, backPack.price, 0, 0, 0, 0};
+    grid = backPack.shape;
+    freeCells = backPack.freeCells;
+    moves.assign(items.size() + 1, {});
+    set<BackPack> solutions;
+    expand(0, 0, solutions);
+    grid = {};
+    moves = {};
+    index.build(solutions);
+    return solutions;
+  }
+
+  // Количество узлов
+  [[nodiscard]] size_t size() const { return nodes.size(); }
+  // Память под узлы
+  [[nodiscard]] size_t memoryBytes() const { return nodes.bytes(); }
+
+  // Состояние рюкзака в узле (0 - корень): укладки пути от корня повторяются на начальном рюкзаке
+  [[nodiscard]] BackPack node(size_t id) const {
+    vector<uint32_t> path;
+    for (uint32_t v = id; v != 0; v = nodes[v].parent) path.push_back(v);
+    BackPack res(backPack.shape, nodes[id].weight, nodes[id].price, backPack.freeCells);
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+      const Node &n = nodes[*it];
+      tryPutItem(shapes[n.item][n.orientation], res.shape, n.row, n.col, char('1' + n.item));
+      res.freeCells -= cells[n.item];
+    }
+    return res;
+  }
+
+  // Поиск всех узлов дерева (в том числе промежуточных) с заданной стоимостью
+  [[nodiscard]] vector<BackPackSearch> search(int price) const {
+    vector<BackPackSearch> res;
+    if (nodes.size() > 0) search(0, price, res);
+    return res;
+  }
+
+ private:
+  ChunkedArena<Node> nodes;
+  vector<Item *> items;
+  vector<vector<Shape>> shapes;  // Повороты каждого предмета в порядке genAllRotations
+  vector<int> cells;             // Количество клеток каждого предмета
+  uint64_t all = 0;              // Маска «положены все предметы»
+  // Состояние построения
+  vector<string> grid;
+  int freeCells = 0;
+  vector<vector<Move>> moves;  // Ходы узла на каждой глубине (без выделений памяти на каждом узле)
+
+  static bool fits(const Shape &item, const vector<string> &bp, int rowOffset, int colOffset) {
+    for (int r = 0; r < item.size(); r++) {
+      for (int c = 0; c < item[r].size(); c++) {
+        if (item[r][c] != '@') continue;
+        int row = rowOffset + r, col = colOffset + c;
+        if (row >= bp.size() || col >= bp[row].size() || bp[row][col] != '_') return false;
+      }
+    }
+    return true;
+  }
+
+  static void clear(const Shape &item, vector<string> &bp, int rowOffset, int colOffset) {
+    for (int r = 0; r < item.size(); r++) {
+      for (int c = 0; c < item[r].size(); c++) {
+        if (item[r][c] == '@') bp[rowOffset + r][colOffset + c] = '_';
+      }
+    }
+  }
+
+  // Построение поддерева узла id (depth - количество положенных предметов, grid - состояние узла).
+  // Сначала выделяются все дети подряд, затем строятся их поддеревья
+  void expand(uint32_t id, int depth, set<BackPack> &solutions) {
+    Node node = nodes[id];
+    vector<Move> &list = moves[depth];
+    list.clear();
+    if (node.used != all) {
+      for (int i = 0; i < items.size(); i++) {
+        if ((node.used >> i) & 1) continue;
+        for (int k = 0; k < shapes[i].size(); k++) {
+          for (int row = 0; row < grid.size(); row++) {
+            for (int col = 0; col < grid[row].size(); col++) {
+              if (grid[row][col] != '#' && fits(shapes[i][k], grid, row, col)) list.push_back({i, k, row, col});
+            }
+          }
+        }
+      }
+    }
+    if (list.empty()) {
+      // Лист: копия изображения - только для новой пары (стоимость, вес)
+      if (!solutions.count(BackPack({}, node.weight, node.price)))
+        solutions.insert(BackPack(grid, node.weight, node.price, freeCells));
+      return;
+    }
+    if (nodes.size() + list.size() > NONE) throw runtime_error("Too many nodes for a compact tree");
+    auto first = uint32_t(nodes.allocate(list.size()));
+    nodes[id].firstChild = first;
+    nodes[id].childCount = list.size();
+    for (int k = 0; k < list.size(); k++) {
+      const Move &m = list[k];
+      nodes[first + k] = Node{node.used | uint64_t(1) << m.item,
+                              id,
+                              0,
+                              0,
+                              node.weight + items[m.item]->weight,
+                              node.price + items[m.item]->price,
+                              uint8_t(m.item),
+                              uint8_t(m.orientation),
+                              uint8_t(m.row),
+                              uint8_t(m.col)};
+    }
+    for (int k = 0; k < list.size(); k++) {
+      const Move &m = list[k];  // Глубже используются списки других глубин
+      const Shape &shape = shapes[m.item][m.orientation];
+      tryPutItem(shape, grid, m.row, m.col, char('1' + m.item));
+      freeCells -= cells[m.item];
+      expand(first + k, depth + 1, solutions);
+      freeCells += cells[m.item];
+      clear(shape, grid, m.row, m.col);
+    }
+  }
+
+  // Дети не упорядочены по стоимости, но стоимость вдоль пути только растёт,
+  // поэтому отсекаем только поддеревья, корень которых уже дороже price
+  void search(uint32_t id, int price, vector<BackPackSearch> &res) const {
+    const Node &parent = nodes[id];
+    for (uint32_t c = parent.firstChild; c < parent.firstChild + parent.childCount; c++) {
+      if (nodes[c].price > price) continue;
+      if (nodes[c].price == price) res.emplace_back(BackPackSearch(node(c), nodes[c].childCount == 0));
+      search(c, price, res);
+    }
+  }
+};
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+using namespace std;
+
+// Блокировка узла для оптимистичной блокировки со связыванием (optimistic lock coupling).
+// Слово версии: бит 1 - узел заблокирован на запись, остальные биты - счётчик версий.
+// Читатель запоминает версию, читает узел без блокировки и проверяет, что версия не изменилась
+class OptLock {
+  atomic<uint64_t> version{0};
+
+  static bool isLocked(uint64_t v) { return (v & 0b10) == 0b10; }
+
+ public:
+  // Начало оптимистичного чтения. needRestart - узел заблокирован писателем
+  uint64_t readLockOrRestart(bool &needRestart) const {
+    uint64_t v = version.load(memory_order_acquire);
+    if (isLocked(v)) {
+      this_thread::yield();
+      needRestart = true;
+    }
+    return v;
+  }
+  // Проверка, что узел не менялся с момента начала чтения
+  void readUnlockOrRestart(uint64_t startRead, bool &needRestart) const {
+    atomic_thread_fence(memory_order_acquire);
+    needRestart = startRead != version.load(memory_order_relaxed);
+  }
+  void checkOrRestart(uint64_t startRead, bool &needRestart) const { readUnlockOrRestart(startRead, needRestart); }
+  // Повышение оптимистичного чтения до блокировки на запись
+  void upgradeToWriteLockOrRestart(uint64_t &v, bool &needRestart) {
+    if (version.compare_exchange_strong(v, v + 0b10, memory_order_acquire)) {
+      v = v + 0b10;
+    } else {
+      this_thread::yield();
+      needRestart = true;
+    }
+  }
+  // Снятие блокировки на запись увеличивает версию
+  void writeUnlock() { version.fetch_add(0b10, memory_order_release); }
+};
+
+// Конкурентное B+-дерево: ключи хранятся в листьях, внутренние узлы содержат разделители.
+// Читатели никогда не блокируются (при конфликте повторяют спуск),
+// писатель блокирует только изменяемый узел и, при расщеплении, его родителя.
+// Узлы не удаляются до уничтожения дерева, поэтому устаревший указатель всегда ведёт в живую память.
+// Поля узлов - атомарные с relaxed-доступом, чтобы оптимистичное чтение не было гонкой данных
+template <typename T, int NodeSize = 64>
+class ConcurrentBTree {
+  static_assert(is_trivially_copyable_v<T>, "Ключи ConcurrentBTree должны быть тривиально копируемыми");
+  static_assert(NodeSize >= 4, "Слишком маленький узел");
+
+  struct Node : OptLock {
+    const bool leaf;
+    atomic<int> count{0};           // Количество ключей
+    atomic<T> keys[NodeSize];       // Ключи (во внутреннем узле keys[i] - максимум в поддереве children[i])
+    explicit Node(bool leaf) : leaf(leaf) {}
+
+    T key(int i) const { return keys[i].load(memory_order_relaxed); }
+    void setKey(int i, T k) { keys[i].store(k, memory_order_relaxed); }
+    int size() const { return count.load(memory_order_relaxed); }
+    bool isFull() const { return size() == NodeSize; }
+    // Индекс первого ключа >= k (двоичный поиск)
+    int lowerBound(const T &k) const {
+      int lo = 0, hi = size();
+      while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (key(mid) < k)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      return lo;
+    }
+  };
+
+  struct Leaf : Node {
+    Leaf() : Node(true) {}
+    // Вставка в неполный лист, false - такой ключ уже есть
+    bool insert(const T &k) {
+      int n = this->size();
+      int pos = this->lowerBound(k);
+      if (pos < n && !(k < this->key(pos))) return false;
+      for (int i = n; i > pos; i--) this->setKey(i, this->key(i - 1));
+      this->setKey(pos, k);
+      this->count.store(n + 1, memory_order_relaxed);
+      return true;
+    }
+    // Расщепление: правая половина уходит в новый лист, sep - максимум левой половины
+    Leaf *split(T &sep) {
+      auto *right = new Leaf();
+      int n = this->size(), half = n / 2;
+      for (int i = half; i < n; i++) right->setKey(i - half, this->key(i));
+      right->count.store(n - half, memory_order_relaxed);
+      this->count.store(half, memory_order_relaxed);
+      sep = this->key(half - 1);
+      return right;
+    }
+  };
+
+  struct Inner : Node {
+    atomic<Node *> children[NodeSize + 1];
+    Inner() : Node(false) {
+      for (auto &c : children) c.store(nullptr, memory_order_relaxed);
+    }
+    Node *child(int i) const { return children[i].load(memory_order_relaxed); }
+    void setChild(int i, Node *c) { children[i].store(c, memory_order_relaxed); }
+    // Вставка разделителя sep и правого ребенка right после расщепления
+    void insert(const T &sep, Node *right) {
+      int n = this->size();
+      int pos = this->lowerBound(sep);
+      for (int i = n; i > pos; i--) {
+        this->setKey(i, this->key(i - 1));
+        setChild(i + 1, child(i));
+      }
+      this->setKey(pos, sep);
+      setChild(pos + 1, right);
+      this->count.store(n + 1, memory_order_relaxed);
+    }
+    // Расщепление: средний ключ поднимается в родителя
+    Inner *split(T &sep) {
+      auto *right = new Inner();
+      int n = this->size(), half = n / 2;
+      sep = this->key(half);
+      for (int i = half + 1; i < n; i++) right->setKey(i - half - 1, this->key(i));
+      for (int i = half + 1; i <= n; i++) right->setChild(i - half - 1, child(i));
+      right->count.store(n - half - 1, memory_order_relaxed);
+      this->count.store(half, memory_order_relaxed);
+      return right;
+    }
+  };
+
+  atomic<Node *> root;
+  atomic<int> count{0};  // Количество ключей
+
+  // Новый корень над двумя половинами старого
+  void makeRoot(const T &sep, Node *left, Node *right) {
+    auto *r = new Inner();
+    r->count.store(1, memory_order_relaxed);
+    r->setKey(0, sep);
+    r->setChild(0, left);
+    r->setChild(1, right);
+    root.store(r, memory_order_release);
+  }
+
+  static void destroy(Node *x) {
+    if (x->leaf) {
+      delete static_cast<Leaf *>(x);
+      return;
+    }
+    auto *inner = static_cast<Inner *>(x);
+    for (int i = 0; i <= inner->size(); i++) destroy(inner->child(i));
+    delete inner;
+  }
+
+ public:
+  ConcurrentBTree() : root(new Leaf()) {}
+  ConcurrentBTree(const ConcurrentBTree &) = delete;
+  ConcurrentBTree &operator=(const ConcurrentBTree &) = delete;
+  ~ConcurrentBTree() { destroy(root.load()); }
+
+  // Количество ключей в дереве
+  [[nodiscard]] int size() const { return count.load(memory_order_relaxed); }
+
+  // Вставка ключа. false - ключ уже был в дереве.
+  // Полные узлы на пути расщепляются заранее, поэтому блокируются не более двух узлов
+  bool insert(const T &k) {
+    while (true) {
+      bool needRestart = false;
+      Node *node = root.load(memory_order_acquire);
+      uint64_t versionNode = node->readLockOrRestart(needRestart);
+      if (needRestart || node != root.load(memory_order_acquire)) continue;
+      Inner *parent = nullptr;
+      uint64_t versionParent = 0;
+      bool restart = false;
+
+      while (!node->leaf) {
+        auto *inner = static_cast<Inner *>(node);
+        if (inner->isFull()) {
+          // Расщепляем полный внутренний узел: блокируем родителя и сам узел
+          if (parent) {
+            parent->upgradeToWriteLockOrRestart(versionParent, needRestart);
+            if (needRestart) break;
+          }
+          node->upgradeToWriteLockOrRestart(versionNode, needRestart);
+          if (needRestart) {
+            if (parent) parent->writeUnlock();
+            break;
+          }
+          if (!parent && node != root.load(memory_order_acquire)) {  // Появился новый корень
+            node->writeUnlock();
+            needRestart = true;
+            break;
+          }
+          T sep;
+          Inner *right = inner->split(sep);
+          if (parent)
+            parent->insert(sep, right);
+          else
+            makeRoot(sep, inner, right);
+          node->writeUnlock();
+          if (parent) parent->writeUnlock();
+          restart = true;
+          break;
+        }
+        if (parent) {
+          parent->readUnlockOrRestart(versionParent, needRestart);
+          if (needRestart) break;
+        }
+        parent = inner;
+        versionParent = versionNode;
+        node = inner->child(inner->lowerBound(k));
+        inner->checkOrRestart(versionNode, needRestart);
+        if (needRestart) break;
+        versionNode = node->readLockOrRestart(needRestart);
+        if (needRestart) break;
+      }
+      if (needRestart || restart) continue;
+
+      auto *leaf = static_cast<Leaf *>(node);
+      if (leaf->isFull()) {
+        // Расщепляем полный лист и повторяем вставку
+        if (parent) {
+          parent->upgradeToWriteLockOrRestart(versionParent, needRestart);
+          if (needRestart) continue;
+        }
+        node->upgradeToWriteLockOrRestart(versionNode, needRestart);
+        if (needRestart) {
+          if (parent) parent->writeUnlock();
+          continue;
+        }
+        if (!parent && node != root.load(memory_order_acquire)) {
+          node->writeUnlock();
+          continue;
+        }
+        T sep;
+        Leaf *right = leaf->split(sep);
+        if (parent)
+          parent->insert(sep, right);
+        else
+          makeRoot(sep, leaf, right);
+        node->writeUnlock();
+        if (parent) parent->writeUnlock();
+        continue;
+      }
+      // Обычная вставка в лист: блокируется только лист
+      node->upgradeToWriteLockOrRestart(versionNode, needRestart);
+      if (needRestart) continue;
+      if (parent) {
+        parent->readUnlockOrRestart(versionParent, needRestart);
+        if (needRestart) {
+          node->writeUnlock();
+          continue;
+        }
+      }
+      bool inserted = leaf->insert(k);
+      node->writeUnlock();
+      if (inserted) count.fetch_add(1, memory_order_relaxed);
+      return inserted;
+    }
+  }
+
+  // Есть ли такой ключ в дереве? Читатель не берёт блокировок
+  bool found(const T &k) const {
+    while (true) {
+      bool needRestart = false;
+      Node *node = root.load(memory_order_acquire);
+      uint64_t versionNode = node->readLockOrRestart(needRestart);
+      if (needRestart || node != root.load(memory_order_acquire)) continue;
+      Inner *parent = nullptr;
+      uint64_t versionParent = 0;
+
+      while (!node->leaf) {
+        auto *inner = static_cast<Inner *>(node);
+        if (parent) {
+          parent->readUnlockOrRestart(versionParent, needRestart);
+          if (needRestart) break;
+        }
+        parent = inner;
+        versionParent = versionNode;
+        node = inner->child(inner->lowerBound(k));
+        inner->checkOrRestart(versionNode, needRestart);
+        if (needRestart) break;
+        versionNode = node->readLockOrRestart(needRestart);
+        if (needRestart) break;
+      }
+      if (needRestart) continue;
+
+      int pos = node->lowerBound(k);
+      bool res = pos < node->size() && !(k < node->key(pos));
+      if (parent) {
+        parent->readUnlockOrRestart(versionParent, needRestart);
+        if (needRestart) continue;
+      }
+      node->readUnlockOrRestart(versionNode, needRestart);
+      if (needRestart) continue;
+      return res;
+    }
+  }
+};
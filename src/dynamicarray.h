@@ -1,19 +1,137 @@
 #pragma once
 
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "common.hpp"
 
+// == Политики учёта "заданных" элементов динамического массива ==
+
+// Заданность элементов хранится упакованным битовым массивом: 1 бит на элемент вместо bool.
+// Биты массивов до 64 элементов хранятся прямо в объекте, без выделения памяти
+class DefinedBits {
+  uint64_t local = 0;        // Биты маленького массива
+  uint64_t *heap = nullptr;  // Биты большого массива (больше 64 элементов), длина words слов
+  int words = 1;
+
+  static int wordsFor(int count) { return (count + 63) / 64; }
+  uint64_t *bits() { return heap != nullptr ? heap : &local; }
+  const uint64_t *bits() const { return heap != nullptr ? heap : &local; }
+
+ public:
+  static constexpr bool dense = false;  // Элементы могут быть не заданы
+
+  DefinedBits() = default;
+  DefinedBits(const DefinedBits &other) : local(other.local), words(other.words) {
+    if (other.heap != nullptr) {
+      heap = new uint64_t[words];
+      memcpy(heap, other.heap, sizeof(uint64_t) * words);
+    }
+  }
+  DefinedBits &operator=(const DefinedBits &) = delete;
+  ~DefinedBits() { delete[] heap; }
+  void swap(DefinedBits &other) noexcept {
+    std::swap(local, other.local);
+    std::swap(heap, other.heap);
+    std::swap(words, other.words);
+  }
+
+  [[nodiscard]] bool get(int i) const { return (bits()[i >> 6] >> (i & 63)) & 1; }
+  void set(int i, bool value) {
+    if (value)
+      bits()[i >> 6] |= uint64_t(1) << (i & 63);
+    else
+      bits()[i >> 6] &= ~(uint64_t(1) << (i & 63));
+  }
+  // Установить биты [from, to) в значение value (целые слова заполняются сразу)
+  void fill(int from, int to, bool value) {
+    uint64_t *b = bits();
+    while (from < to && (from & 63) != 0) set(from++, value);
+    for (; from + 64 <= to; from += 64) b[from >> 6] = value ? ~uint64_t(0) : 0;
+    while (from < to) set(from++, value);
+  }
+  // Перевыделение под capacity элементов с сохранением первых size бит
+  void reallocate(int size, int capacity) {
+    int newWords = max(1, wordsFor(capacity));
+    if (newWords == 1) {
+      if (heap != nullptr) local = heap[0];
+      delete[] heap;
+      heap = nullptr;
+    } else {
+      auto *newBits = new uint64_t[newWords]();
+      memcpy(newBits, bits(), sizeof(uint64_t) * min(words, max(1, wordsFor(size))));
+      delete[] heap;
+      heap = newBits;
+    }
+    words = newWords;
+  }
+  // Вставка бита в позицию index: биты [index, size) сдвигаются на один вверх
+  void insertAt(int index, int size) {
+    uint64_t *b = bits();
+    int first = index >> 6, last = size >> 6;
+    for (int w = last; w > first; w--) b[w] = (b[w] << 1) | (b[w - 1] >> 63);
+    uint64_t low = (uint64_t(1) << (index & 63)) - 1;
+    b[first] = (b[first] & low) | ((b[first] << 1) & ~low);
+  }
+  // Удаление бита index: биты [index + 1, size) сдвигаются на один вниз
+  void removeAt(int index, int size) {
+    uint64_t *b = bits();
+    int first = index >> 6, last = (size - 1) >> 6;
+    uint64_t low = (uint64_t(1) << (index & 63)) - 1;
+    uint64_t carry = first < last ? b[first + 1] << 63 : 0;
+    b[first] = (b[first] & low) | ((b[first] >> 1) & ~low) | carry;
+    for (int w = first + 1; w <= last; w++) b[w] = (b[w] >> 1) | (w < last ? b[w + 1] << 63 : 0);
+  }
+};
+
+// Плотный массив: все элементы всегда заданы, память под признаки и проверки не нужны
+class AllDefined {
+ public:
+  static constexpr bool dense = true;
+
+  void swap(AllDefined &) noexcept {}
+  [[nodiscard]] bool get(int) const { return true; }
+  void set(int, bool) {}
+  void fill(int, int, bool) {}
+  void reallocate(int, int) {}
+  void insertAt(int, int) {}
+  void removeAt(int, int) {}
+};
+
+// Встроенный в объект буфер на N элементов (small-buffer optimization)
+template <class T, int N>
+struct InlineBuffer {
+  alignas(T) unsigned char bytes[sizeof(T) * N];
+  T *get() { return reinterpret_cast<T *>(bytes); }
+};
+template <class T>
+struct InlineBuffer<T, 0> {
+  T *get() { return nullptr; }
+};
+
 // АТД контейнер: динамический массив
 // Массив состоит из элементов типа T
+// Definedness - политика учёта заданных элементов: DefinedBits (по умолчанию) или AllDefined
+// InlineCapacity - сколько элементов хранится прямо в объекте без обращения к аллокатору
+// Alloc - аллокатор для массивов, не поместившихся во встроенный буфер (например, ArenaAllocator)
 // DynamicArray<int> da1(2);
 // DynamicArray<char> da2(2);
-template <class T>
+// DynamicArray<double, AllDefined> da3(2);
+// DynamicArray<int, DefinedBits, 16> da4(2);
+template <class T, class Definedness = DefinedBits, int InlineCapacity = 0, class Alloc = allocator<T>>
 class DynamicArray {
   int size;       // Количество элементов массива
-  T *data;        // Данные массива
-  bool *defined;  // Задан ли элемент массива?
+  int capacity;   // Под сколько элементов выделена память (capacity >= size, capacity >= InlineCapacity)
+  T *data;        // Данные массива: элементы [0, size) сконструированы, [size, capacity) - сырая память
+  Definedness defined;  // Задан ли элемент массива? (capacity бит)
+  Alloc alloc;          // Аллокатор для памяти вне встроенного буфера
+  InlineBuffer<T, InlineCapacity> inlineBuffer;  // Встроенный буфер для маленьких массивов
+  // Память, выделенная одним экземпляром аллокатора, освобождается другим (при перемещении)
+  static_assert(allocator_traits<Alloc>::is_always_equal::value, "Аллокатор должен быть без состояния");
   // Проверка - является ли индекс допустимым? Если нет => генерируется исключение
   void checkIndex(int index) const {
     // Может выбрасывать исключения:
@@ -22,34 +140,88 @@ class DynamicArray {
       throw IndexOutOfRange(string("Index ") + to_string(index) + " out of range 0.." + to_string(size - 1));
     }
   }
+  // Выделение и освобождение памяти без конструирования элементов.
+  // Маленькие массивы размещаются во встроенном буфере
+  T *allocate(int count) {
+    if (count <= InlineCapacity) return inlineBuffer.get();
+    return allocator_traits<Alloc>::allocate(alloc, count);
+  }
+  void deallocate(T *p, int count) {
+    if (p != nullptr && p != inlineBuffer.get()) allocator_traits<Alloc>::deallocate(alloc, p, count);
+  }
+  // Перенос count сконструированных элементов из from в сырую память to.
+  // Для тривиально копируемых T - один memcpy, для остальных - перемещение и разрушение исходных
+  static void relocate(T *from, int count, T *to) {
+    if constexpr (is_trivially_copyable_v<T>) {
+      if (count > 0) memcpy(to, from, sizeof(T) * count);
+    } else {
+      uninitialized_move(from, from + count, to);
+      destroy(from, from + count);
+    }
+  }
+  // Копирование count элементов в сырую память to
+  static void copyTo(const T *from, int count, T *to) {
+    if constexpr (is_trivially_copyable_v<T>) {
+      if (count > 0) memcpy(to, from, sizeof(T) * count);
+    } else {
+      uninitialized_copy(from, from + count, to);
+    }
+  }
+  // Перевыделение памяти под newCapacity элементов (newCapacity >= size)
+  void reallocate(int newCapacity) {
+    newCapacity = max(newCapacity, InlineCapacity);
+    if (newCapacity == capacity) return;
+    T *newData = allocate(newCapacity);
+    relocate(data, size, newData);
+    defined.reallocate(size, newCapacity);
+    deallocate(data, capacity);
+    data = newData;
+    capacity = newCapacity;
+  }
+  // Гарантировать место хотя бы под minCapacity элементов.
+  // Ёмкость растёт геометрически, поэтому серия append/prepend/insertAt работает за амортизированное O(1) выделений
+  void grow(int minCapacity) {
+    if (minCapacity > capacity) reallocate(max(minCapacity, max(2 * capacity, 4)));
+  }
+  // Забрать содержимое другого массива (этот массив пуст и использует встроенный буфер).
+  // Элементы из встроенного буфера переносятся, память из аллокатора забирается целиком
+  void takeFrom(DynamicArray &other) {
+    if (other.data == other.inlineBuffer.get()) {
+      relocate(other.data, other.size, data);
+    } else {
+      data = other.data;
+      capacity = other.capacity;
+      other.data = other.inlineBuffer.get();
+      other.capacity = InlineCapacity;
+    }
+    size = other.size;
+    other.size = 0;
+    defined.swap(other.defined);
+    other.defined.reallocate(0, other.capacity);
+  }
 
  public:  // Делаем доступными извне класса конструкторы и методы-операции
   // == Создание объекта - конструкторы ==
   // Копировать элементы из переданного массива
   // - data - массив значений типа T для инициализации динамического массива
   // - count - количество этих значений
-  DynamicArray(T *items, int count) : size(count) {  // Записываем количество элементов в поле size
+  DynamicArray(T *items, int count, const Alloc &alloc = Alloc())
+      : size(count), capacity(max(count, InlineCapacity)), alloc(alloc) {  // Записываем количество элементов в поле size
     if (size < 0) throw IndexOutOfRange("Size < 0");
-    // new MyClass - динамическая память для одного экземляра данного класса
-    // new MyClass[10] - динамическая память для 10 экземпляров класса
-    data = new T[size];  // Создаём в динамической памяти массив заданного размера
-    defined = new bool[size];
-    memcpy(data, items, sizeof(T) * size);  // Копируем как кусочек памяти: data <- data
+    data = allocate(capacity);  // Выделяем место под массив заданного размера
+    copyTo(items, size, data);  // Тривиальные типы копируем как кусочек памяти, остальные - поэлементно
     // Считаем что изначально все элементы заданы
-    for (int i = 0; i < size; i++) {
-      // data[i] = data[i];
-      defined[i] = true;  // Элемент задан
-    }
+    defined.reallocate(0, capacity);
+    defined.fill(0, size, true);
   };
   // Создать массив заданной длины count
-  explicit DynamicArray(int count = 0) : size(count) {
+  explicit DynamicArray(int count = 0, const Alloc &alloc = Alloc())
+      : size(count), capacity(max(count, InlineCapacity)), alloc(alloc) {
     if (size < 0) throw IndexOutOfRange("Count < 0");
-    data = new T[size];  // Создаём в динамической памяти массив заданного размера
-    // Считаем что изначально все элементы "не заданы"
-    defined = new bool[size];
-    for (int i = 0; i < size; i++) {
-      defined[i] = false;  // Элемент "не задан"
-    }
+    data = allocate(capacity);  // Выделяем место под массив заданного размера
+    uninitialized_value_construct_n(data, size);
+    // Считаем что изначально все элементы "не заданы" (у плотного массива все заданы)
+    defined.reallocate(0, capacity);
   }
   explicit DynamicArray(initializer_list<T> list) : DynamicArray(list.size()) {
     int i = 0;
@@ -60,27 +232,53 @@ class DynamicArray {
   }
   // Копирующий конструктор - создаёт обьект-копию другого обьекта
   // Цель: менять новый обьект не затрагивая старый
-  DynamicArray(const DynamicArray<T> &dynamicArray) {
-    size = dynamicArray.size;  // Тот же размер у нового массива что у исходного
-    // Копируем элементы
-    data = new T[dynamicArray.size];
-    memcpy(data, dynamicArray.data, dynamicArray.size * sizeof(T));
-    // Копируем какие элементы определены
-    defined = new bool[dynamicArray.size];
-    memcpy(defined, dynamicArray.defined, dynamicArray.size * sizeof(bool));
+  DynamicArray(const DynamicArray &dynamicArray)
+      : size(dynamicArray.size),
+        capacity(max(dynamicArray.size, InlineCapacity)),
+        defined(dynamicArray.defined),
+        alloc(allocator_traits<Alloc>::select_on_container_copy_construction(dynamicArray.alloc)) {
+    // Копируем элементы (какие элементы определены - скопировано вместе с политикой)
+    data = allocate(capacity);
+    copyTo(dynamicArray.data, size, data);
+  }
+  // Перемещающий конструктор - забирает память у другого объекта, который становится пустым
+  DynamicArray(DynamicArray &&dynamicArray) noexcept
+      : size(0), capacity(InlineCapacity), alloc(std::move(dynamicArray.alloc)) {
+    data = inlineBuffer.get();
+    defined.reallocate(0, capacity);
+    takeFrom(dynamicArray);
+  }
+  // Присваивание копированием и перемещением
+  DynamicArray &operator=(const DynamicArray &dynamicArray) {
+    if (this != &dynamicArray) {
+      DynamicArray copy(dynamicArray);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+  DynamicArray &operator=(DynamicArray &&dynamicArray) noexcept {
+    if (this != &dynamicArray) {
+      // Освобождаем свои элементы и забираем чужие
+      destroy(data, data + size);
+      deallocate(data, capacity);
+      data = inlineBuffer.get();
+      capacity = InlineCapacity;
+      size = 0;
+      takeFrom(dynamicArray);
+    }
+    return *this;
   }
   // == Деструктор - очистка памяти ==
   ~DynamicArray() {
-    delete[] data;
+    destroy(data, data + size);
+    deallocate(data, capacity);
     data = nullptr;  // NULL - нулевой указатель, nullptr - нулевой указатель, который не будет автоматически
     // приводиться к другим типам
-    delete[] defined;
-    defined = nullptr;
   }
   // == Декомпозиция ==
   T &get(int index) const {  // Получить элемент по индексу
     checkIndex(index);  // Проверяем индекс и генерируем исключение если он неверный
-    if (!defined[index]) {
+    if (!Definedness::dense && !defined.get(index)) {
       throw IndexOutOfRange(string("Element with index ") + to_string(index) + " not defined");
     }
     return data[index];
@@ -88,15 +286,18 @@ class DynamicArray {
   [[nodiscard]] int getSize() const {  // Получить размер массива
     return size;
   }
+  [[nodiscard]] int getCapacity() const {  // Под сколько элементов выделена память
+    return capacity;
+  }
   // == Операции ==
   // Задать значение элемента по индексу
   // index - индекс изменяемого элемента
   // value - новое значение элемента
   void set(int index, T value) {
     checkIndex(index);  // Может выбросить IndexOutOfRange
-    data[index] = value;
+    data[index] = std::move(value);
     // Если элемент был "не задан" => он становится задан
-    defined[index] = true;
+    defined.set(index, true);
   }
   // Перегруженные операторы чтобы можно было обращаться к элементу как в
   // обычном массиве
@@ -105,35 +306,50 @@ class DynamicArray {
   }
   T &operator[](size_t index) {  // Чтобы делать присваивание так: dynamicArray[1] = 1233;
     checkIndex(index);
-    defined[index] = true;
+    defined.set(index, true);
+    return data[index];
+  }
+  // Доступ без проверки индекса и заданности - для горячих циклов, где индекс заведомо верный
+  T &getUnchecked(int index) {
     return data[index];
   }
+  const T &getUnchecked(int index) const {
+    return data[index];
+  }
+  // Считать все элементы заданными (после заполнения через getUnchecked/getData)
+  void defineAll() {
+    defined.fill(0, size, true);
+  }
+  // Указатель на непрерывный блок элементов [0, getSize())
+  T *getData() {
+    return data;
+  }
+  const T *getData() const {
+    return data;
+  }
   // Изменить размер массива (уменьшить или увеличить)
   void resize(int newSize) {
     if (newSize < 0) {
       throw bad_array_new_length();
     }
-    T *newData = new T[newSize];
-    bool *newDefined = new bool[newSize];
-    // Если размер увеличивается, все элементы копируются в начало новой памяти
+    // Если размер увеличивается, новые элементы добавляются в конец и считаются "не заданными"
     // Если уменьшается – элементы, которые не помещаются, отбрасываются
-    for (int i = 0; i < min(size, newSize); i++) {
-      newData[i] = data[i];
-      newDefined[i] = defined[i];
-    }
-    memcpy(newData, data, sizeof(T) * min(size, newSize));
-    // Копируем какие элементы определены
-    memcpy(newDefined, defined, sizeof(bool) * min(size, newSize));
-    // Оставшиеся заполняем false - будет работать только если newSize > size
-    for (int i = size; i < newSize; i++) {
-      newDefined[i] = false;
-    }
-    // Обновляем количество элементов, сами элементы и какие определены
+    if (newSize > size) {
+      grow(newSize);
+      uninitialized_value_construct(data + size, data + newSize);
+      defined.fill(size, newSize, false);
+    } else {
+      destroy(data + newSize, data + size);
+    }
     size = newSize;
-    delete[] data;  // Очищаем память
-    data = newData;
-    delete[] defined;  // Очищаем память
-    defined = newDefined;
+  }
+  // Зарезервировать память под newCapacity элементов, размер массива не меняется
+  void reserve(int newCapacity) {
+    if (newCapacity > capacity) reallocate(newCapacity);
+  }
+  // Освободить неиспользуемую память (capacity = size)
+  void shrink_to_fit() {
+    if (capacity > size) reallocate(size);
   }
   // Меняем элементы i и j местами
   // Может быть использовано для сортировки и других алгоритмов
@@ -143,48 +359,68 @@ class DynamicArray {
     set(j, temp);
   }
   void append(T item) {
-    resize(size + 1);  // Увеличиваем массив на 1
-    set(size - 1, item);
+    grow(size + 1);  // Увеличиваем ёмкость, если места не осталось
+    new (data + size) T(std::move(item));
+    defined.set(size, true);
+    size++;
+  }
+  // Добавить в конец count элементов из непрерывного блока items - одно выделение памяти
+  // и один memcpy для тривиально копируемых T
+  void appendRange(const T *items, int count) {
+    grow(size + count);
+    copyTo(items, count, data + size);
+    defined.fill(size, size + count, true);
+    size += count;
+  }
+  // Добавить в конец элементы other[start, start + count) вместе с признаками заданности
+  // Может выбрасывать исключения: IndexOutOfRange (если диапазон выходит за границы other)
+  void appendRange(const DynamicArray &other, int start, int count) {
+    if (start < 0 || count < 0 || start + count > other.size) {
+      throw IndexOutOfRange(string("Range ") + to_string(start) + ".." + to_string(start + count - 1) +
+                            " out of range 0.." + to_string(other.size - 1));
+    }
+    grow(size + count);
+    copyTo(other.data + start, count, data + size);
+    for (int i = 0; i < count; i++) defined.set(size + i, other.defined.get(start + i));
+    size += count;
   }
   // Добавляем элемент в начало массива
   void prepend(T item) {
-    resize(size + 1);  // Увеличиваем массив на 1
-    // Сдвигаем все элементы вправо (в сторону увеличения индексов)
-    for (int i = size - 1; i >= 1; i--) {
-      data[i] = data[i - 1];
-      defined[i] = defined[i - 1];
-    }
-    // Вставляем новый элемент как первый
-    data[0] = item;
-    defined[0] = true;
+    insertAt(std::move(item), 0);
   }
-  // Вставляет элемент в заданную позицию
+  // Вставляет элемент в заданную позицию (index == getSize() - вставка в конец)
   // Может выбрасывать исключения:
-  // − IndexOutOfRange (если индекс отрицательный или больше/равен числу элементов)
+  // − IndexOutOfRange (если индекс отрицательный или больше числа элементов)
   void insertAt(T item, int index) {
-    resize(size + 1);  // Увеличиваем размер на 1
-    checkIndex(index);  // Проверяем индекс и генерируем исключение если он неверный
-    // Сдвигаем все элементы вправо
-    for (int i = size - 1; i > index; i--) {
-      data[i] = data[i - 1];
-      defined[i] = defined[i - 1];
+    if (index < 0 || index > size) {
+      throw IndexOutOfRange(string("Index ") + to_string(index) + " out of range 0.." + to_string(size));
+    }
+    if (index == size) {
+      append(std::move(item));
+      return;
     }
-    set(index, item);
+    grow(size + 1);  // Увеличиваем ёмкость, если места не осталось
+    // Сдвигаем все элементы вправо: последний переносим в сырую память, остальные - перемещением
+    new (data + size) T(std::move(data[size - 1]));
+    move_backward(data + index, data + size - 1, data + size);
+    defined.insertAt(index, size);
+    size++;
+    set(index, std::move(item));
   };
   // Удаление элемента по индексу
   void removeAt(const int index) {
     checkIndex(index);  // Проверяем индекс и генерируем исключение если он неверный
-    for (int i = index + 1; i < size; i++) {  // Сдвигаем все элементы начиная с index+1 влево на один
-      data[i - 1] = data[i];  // Сдвигаем значение
-      defined[i - 1] = defined[i];
-    }
-    resize(size - 1);  // Уменьшаем размер массива
+    // Сдвигаем все элементы начиная с index+1 влево на один
+    std::move(data + index + 1, data + size, data + index);
+    defined.removeAt(index, size);
+    size--;  // Уменьшаем размер массива
+    destroy_at(data + size);
   }
   // Печать динамического массива
   void print() {
     wcout << L"DynamicArray size = " << size << L":";
     for (int i = 0; i < size; i++) {
-      if (defined[i])
+      if (defined.get(i))
         wcout << L" " << data[i];
       else
         wcout << L" *";  // Если элемент "не задан" => печатается звёздочка *
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <type_traits>
+using namespace std;
+
+// B-дерево с минимальной степенью t, заданной на этапе компиляции.
+// В отличие от BTree<T> ключи и дети хранятся прямо в узле (один блок памяти,
+// выровненный по границе кэш-линии), поэтому посещение узла - один промах кэша, а не три.
+// Поиск внутри узла двоичный, ключи передаются по константной ссылке
+template <typename T, int t = 16>
+class FlatBTree {
+  static_assert(t >= 2, "Минимальная степень B-дерева должна быть не меньше 2");
+  static constexpr int MAX_KEYS = 2 * t - 1;  // Максимальное количество ключей в узле
+
+  // Узел B-дерева: ключи и указатели на детей в одном блоке
+  struct alignas(64) Node {
+    int n = 0;             // Текущее количество ключей
+    bool leaf = true;      // Является ли узел листом
+    T keys[MAX_KEYS];      // Ключи по возрастанию
+    Node *C[2 * t] = {};   // Дочерние узлы
+
+    explicit Node(bool leaf) : leaf(leaf) {}
+
+    // Индекс первого ключа >= k
+    int lowerBound(const T &k) const {
+      if constexpr (is_arithmetic_v<T>) {
+        // Двоичный поиск без ветвлений: компилятор превращает выбор в cmov
+        const T *base = keys;
+        int len = n;
+        while (len > 1) {
+          int half = len / 2;
+          base = (base[half - 1] < k) ? base + half : base;
+          len -= half;
+        }
+        return int(base - keys) + (len == 1 && *base < k);
+      } else {
+        return int(std::lower_bound(keys, keys + n, k) - keys);
+      }
+    }
+  };
+
+  Node *root = nullptr;  // Указатель на корень
+  int count = 0;         // Количество ключей в дереве
+
+  // Освобождение поддерева
+  static void destroy(Node *x) {
+    if (x == nullptr) return;
+    if (!x->leaf) {
+      for (int i = 0; i <= x->n; i++) destroy(x->C[i]);
+    }
+    delete x;
+  }
+
+  // Функция для разделения полного ребёнка y = x->C[i]
+  static void splitChild(Node *x, int i, Node *y) {
+    auto *z = new Node(y->leaf);
+    z->n = t - 1;
+    // копируем последние (t-1) ключа из y в z
+    for (int j = 0; j < t - 1; j++) z->keys[j] = std::move(y->keys[j + t]);
+    // копируем последние t детей из y в z
+    if (!y->leaf) {
+      for (int j = 0; j < t; j++) z->C[j] = y->C[j + t];
+    }
+    y->n = t - 1;
+    // У этого узла будет новый ребенок, выдаем место
+    for (int j = x->n; j >= i + 1; j--) x->C[j + 1] = x->C[j];
+    x->C[i + 1] = z;
+    // Находим положение ключа и двигаем другие
+    for (int j = x->n - 1; j >= i; j--) x->keys[j + 1] = std::move(x->keys[j]);
+    x->keys[i] = std::move(y->keys[t - 1]);
+    x->n++;
+  }
+
+  // Вставка нового ключа в неполное поддерево узла x
+  static void insertNonFull(Node *x, const T &k) {
+    while (!x->leaf) {
+      int i = x->lowerBound(k);
+      // Смотрим, полон ли найденный ребенок
+      if (x->C[i]->n == MAX_KEYS) {
+        splitChild(x, i, x->C[i]);
+        if (x->keys[i] < k) i++;
+      }
+      x = x->C[i];
+    }
+    // Лист: сдвигаем ключи и вставляем новый ключ в найденное место
+    int i = x->lowerBound(k);
+    for (int j = x->n; j > i; j--) x->keys[j] = std::move(x->keys[j - 1]);
+    x->keys[i] = k;
+    x->n++;
+  }
+
+  static void traverse(const Node *x) {
+    int i;
+    for (i = 0; i < x->n; i++) {
+      if (!x->leaf) traverse(x->C[i]);
+      cout << " " << x->keys[i];
+    }
+    if (!x->leaf) traverse(x->C[i]);
+  }
+
+ public:
+  FlatBTree() = default;
+  FlatBTree(const FlatBTree &) = delete;
+  FlatBTree &operator=(const FlatBTree &) = delete;
+  ~FlatBTree() { destroy(root); }
+
+  // Количество ключей в дереве
+  [[nodiscard]] int size() const { return count; }
+
+  // Обход дерева для вывода
+  void traverse() const {
+    if (root != nullptr) traverse(root);
+  }
+
+  // Поиск по ключу k. Возвращает указатель на найденный ключ или nullptr
+  const T *search(const T &k) const {
+    const Node *x = root;
+    while (x != nullptr) {
+      int i = x->lowerBound(k);
+      if (i < x->n && !(k < x->keys[i])) return &x->keys[i];
+      if (x->leaf) return nullptr;
+      x = x->C[i];
+    }
+    return nullptr;
+  }
+
+  // Есть ли такой ключ в дереве?
+  bool found(const T &k) const { return search(k) != nullptr; }
+
+  // Вставка ключа
+  void insert(const T &k) {
+    count++;
+    if (root == nullptr) {
+      root = new Node(true);
+      root->keys[0] = k;
+      root->n = 1;
+      return;
+    }
+    // Если корень полный, то дерево увеличивается в высоту
+    if (root->n == MAX_KEYS) {
+      auto *s = new Node(false);
+      s->C[0] = root;
+      splitChild(s, 0, root);
+      root = s;
+    }
+    insertNonFull(root, k);
+  }
+};
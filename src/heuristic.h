@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "backpack.h"
+
+using namespace std;
+
+// Быстрая приближённая укладка: жадный алгоритм по удельной стоимости с размещением
+// «снизу-слева» и имитация отжига по порядку предметов и выбору поворотов.
+// Предметы кладутся по правилам tryPutItem, а раскладка всегда «максимальная» - ни один
+// из оставшихся предметов в неё уже не помещается, то есть это лист дерева решений SolutionTree.
+// Поэтому стоимость найденного решения - честная нижняя граница для точного перебора
+// (см. SolverOptions::minPrice)
+
+// Параметры эвристики
+struct HeuristicOptions {
+  int maxWeight = INT_MAX;  // Ограничение на суммарный вес
+  int iterations = 2000;    // Количество шагов отжига (0 - только жадный алгоритм)
+  unsigned seed = 1;        // Зерно генератора: при одинаковых входных данных результат повторяется
+};
+
+// Отпечаток параметров эвристики (для кэша результатов)
+uint64_t optionsHash(const HeuristicOptions &options) {
+  Fnv1a h;
+  h.add(options.maxWeight);
+  h.add(options.iterations);
+  h.add((long long)options.seed);
+  return h.value;
+}
+
+class HeuristicPacker {
+ public:
+  explicit HeuristicPacker(const BackPack &bp, HeuristicOptions options = {}) : backPack(bp), options(options) {}
+
+  // Жадное решение: предметы по убыванию удельной стоимости (стоимость на клетку)
+  BackPack greedy(const vector<Item *> &items) {
+    prepare(items);
+    return decode(densityOrder(), vector<int>(items.size(), 0));
+  }
+
+  // Жадное решение, улучшенное отжигом. Лучшее решение с весом не больше maxWeight;
+  // если такого не нашлось, found() == false и возвращается пустой рюкзак
+  BackPack solve(const vector<Item *> &items) {
+    prepare(items);
+    int n = items.size();
+    vector<int> order = densityOrder(), orientation(n, 0);
+    BackPack current = decode(order, orientation);
+    double currentScore = score(current);
+    BackPack best = current;
+    double bestScore = currentScore;
+
+    mt19937 random(options.seed);
+    // Начальная температура - порядка стоимости одного предмета, к концу почти ноль
+    double maxPrice = 1;
+    for (auto *item : items) maxPrice = max(maxPrice, double(item->price));
+    double temperature = maxPrice, cooling = pow(0.001, 1.0 / max(1, options.iterations));
+    for (int step = 0; step < options.iterations && n > 0; step++, temperature *= cooling) {
+      // Соседнее состояние: переставить два предмета в порядке или сменить поворот одного
+      vector<int> nextOrder = order, nextOrientation = orientation;
+      if (n > 1 && random() % 2 == 0) {
+        int a = random() % n, b = random() % n;
+        swap(nextOrder[a], nextOrder[b]);
+      } else {
+        int i = random() % n;
+        nextOrientation[i] = random() % shapes[i].size();
+      }
+      BackPack candidate = decode(nextOrder, nextOrientation);
+      double candidateScore = score(candidate);
+      // Правило Метрополиса: хуже - с вероятностью exp(-Δ/T)
+      if (candidateScore >= currentScore ||
+          uniform_real_distribution<double>(0, 1)(random) < exp((candidateScore - currentScore) / temperature)) {
+        order.swap(nextOrder);
+        orientation.swap(nextOrientation);
+        current = std::move(candidate);
+        currentScore = candidateScore;
+        if (currentScore > bestScore) {
+          best = current;
+          bestScore = currentScore;
+        }
+      }
+    }
+    feasible = best.weight <= options.maxWeight;
+    return feasible ? best : BackPack();
+  }
+
+  // Нашлось ли при последнем solve решение с допустимым весом
+  [[nodiscard]] bool found() const { return feasible; }
+
+ private:
+  BackPack backPack;
+  HeuristicOptions options;
+  vector<const Item *> items;
+  vector<vector<Shape>> shapes;  // Повороты каждого предмета в порядке genAllRotations
+  vector<int> itemCells;         // Количество клеток каждого предмета
+  bool feasible = false;
+
+  void prepare(const vector<Item *> &source) {
+    items.assign(source.begin(), source.end());
+    shapes.assign(items.size(), {});
+    itemCells.assign(items.size(), 0);
+    for (int i = 0; i < items.size(); i++) {
+      for (auto &shape : genAllRotations(items[i]->shape)) shapes[i].push_back(shape);
+      for (auto &row : items[i]->shape) itemCells[i] += count(row.begin(), row.end(), '@');
+    }
+    feasible = false;
+  }
+
+  // Порядок предметов по убыванию стоимости на клетку (при равенстве - более дорогие раньше)
+  vector<int> densityOrder() const {
+    vector<int> order(items.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [this](int a, int b) {
+      long long left = (long long)items[a]->price * max(1, itemCells[b]);
+      long long right = (long long)items[b]->price * max(1, itemCells[a]);
+      if (left != right) return left > right;
+      return items[a]->price > items[b]->price;
+    });
+    return order;
+  }
+
+  // Проверка без изменения сетки - те же условия, что в tryPutItem
+  static bool fits(const Shape &item, const vector<string> &bp, int rowOffset, int colOffset) {
+    for (int r = 0; r < item.size(); r++) {
+      for (int c = 0; c < item[r].size(); c++) {
+        if (item[r][c] != '@') continue;
+        int row = rowOffset + r, col = colOffset + c;
+        if (row >= bp.size() || col >= bp[row].size() || bp[row][col] != '_') return false;
+      }
+    }
+    return true;
+  }
+
+  // Положить предмет «снизу-слева»: самая нижняя строка, в ней самый левый столбец
+  static bool putBottomLeft(const Shape &item, vector<string> &bp, char symbol) {
+    for (int row = int(bp.size()) - 1; row >= 0; row--) {
+      for (int col = 0; col < bp[row].size(); col++) {
+        if (bp[row][col] == '#' || !fits(item, bp, row, col)) continue;
+        tryPutItem(item, bp, row, col, symbol);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Раскладка по порядку предметов: каждый кладётся первым подходящим поворотом,
+  // начиная с выбранного. Предмет, который не поместился, не поместится и позже
+  BackPack decode(const vector<int> &order, const vector<int> &orientation) const {
+    BackPack res(backPack.shape, backPack.weight, backPack.price);
+    for (int i : order) {
+      int m = shapes[i].size();
+      for (int t = 0; t < m; t++) {
+        if (putBottomLeft(shapes[i][(orientation[i] + t) % m], res.shape, char('1' + i))) {
+          res.weight += items[i]->weight;
+          res.price += items[i]->price;
+          res.freeCells -= itemCells[i];
+          break;
+        }
+      }
+    }
+    return res;
+  }
+
+  // Оценка: допустимые решения - по стоимости (при равной - легче лучше), недопустимые - хуже любого допустимого
+  double score(const BackPack &bp) const {
+    if (bp.weight > options.maxWeight) return -1.0 - (bp.weight - options.maxWeight);
+    return bp.price - bp.weight * 1e-6;
+  }
+};
@@ -4,15 +4,23 @@
 
 #include <chrono>
 #include <complex>
+#include <csignal>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cwchar>
 #include <fstream>
 #include <random>
+#include <thread>
 
+#include "asyncsolve.h"
 #include "backpack.h"
+#include "heuristic.h"
 #include "menu.h"
+#include "objective.h"
+#include "resultcache.h"
+#include "shard.h"
+#include "solver.h"
 
 using namespace std::chrono;
 
@@ -30,108 +38,178 @@ void main_menu1() {
   menuLoop(L"Возможные операции", _countof(menu), menu);
 }
 
-struct AllSolutions
+// Ctrl+C во время перебора отменяет перебор, а не завершает программу
+volatile sig_atomic_t interruptRequested = 0;
+
+void onInterrupt(int)
 {
-  vector<BackPack> sol1; // Вывести все уникальные решения (различная цена и вес), отсортированные по цене
-  vector<BackPack> sol2; // Стоимость предметов максимальная, вес не превосходит заданной величины и эффективное заполнение
-  BackPack sol3; // Стоимость предметов в рюкзаке была максимальной, а суммарный вес минимальный
-  vector<BackPack> sol4; // Стоимость предметов максимальная, заполнение максимальное, вес не превосходит заданной величины
-  int time_milliseconds;
+  interruptRequested = 1;
+}
 
-  explicit AllSolutions()
+// Перебор в фоновом потоке. Пока он идёт, печатается ход перебора;
+// Ctrl+C останавливает перебор, и возвращаются уже найденные решения (complete = false)
+set<BackPack> solveInteractive(const BackPack &bp, const vector<Item *> &items, const SolverOptions &options, bool &complete)
+{
+  interruptRequested = 0;
+  auto previous = signal(SIGINT, onInterrupt);
+  AsyncSolve solve(bp, items, options);
+  auto nextReport = chrono::steady_clock::now() + chrono::milliseconds(250);
+  bool reported = false;
+  while (!solve.poll())
   {
-    Config cfg("../input.txt");
-    int max_weight = cfg.maxWeight;
-    SolutionTree tree(cfg.backPack);
-    auto begin = chrono::steady_clock::now();
-    auto solutions = tree.solve(cfg.items);
-    auto end = chrono::steady_clock::now();
-    auto time = chrono::duration_cast<chrono::milliseconds>(end - begin);
-    time_milliseconds = time.count();
-    wcout << "Time: " << time.count() << " mls\n";
-    wcout << "Number of solutions: " << solutions.size() << "\n";
+    this_thread::sleep_for(chrono::milliseconds(10));
+    if (interruptRequested)
+      solve.cancel();
+    if (chrono::steady_clock::now() < nextReport)
+      continue;
+    SolveProgress p = solve.progress();
+    wcout << L"\rУзлов: " << p.nodes << L", лучшая стоимость: ";
+    if (p.found)
+      wcout << p.bestPrice;
+    else
+      wcout << L"-";
+    wcout << L", пройдено " << int(p.fraction * 100) << L"% (Ctrl+C - остановить)   " << flush;
+    reported = true;
+    nextReport = chrono::steady_clock::now() + chrono::milliseconds(250);
+  }
+  signal(SIGINT, previous);
+  if (reported)
+    wcout << L"\n";
+  set<BackPack> res = solve.get();
+  complete = !solve.stopped();
+  return res;
+}
 
-    sol1.resize(solutions.size());
-    int size = 0;
-    for (auto &backpack: solutions)
-      sol1[size++] = backpack;
+// Решения задачи с рюкзаком заданной формы. Каждый пункт меню - отдельный целевой поиск
+// (см. solveObjective), результаты запоминаются на диске (ResultCache). Перебор можно прервать,
+// тогда выводятся найденные к этому моменту решения (в кэш они не попадают)
+struct AllSolutions
+{
+  Config cfg;
+  ResultCache cache;
+  bool complete = true; // Последний поиск дошёл до конца
 
-    for (int i = sol1.size() - 1; i >= 0; i--)
+  explicit AllSolutions() : cfg("../input.txt") {}
+
+  // Все уникальные решения (различная цена и вес), отсортированные по цене
+  vector<BackPack> all()
+  {
+    return timed([this]()
     {
-      if (sol1[i].weight <= max_weight)
+      vector<BackPack> res;
+      uint64_t key = ResultCache::key(cfg.backPack, cfg.items, "all", optionsHash(SolverOptions()));
+      if (!cache.load(key, res))
       {
-        int j = i;
-        while (j >= 0 && sol1[i].price == sol1[j].price)
-        {
-          sol2.emplace_back(sol1[j]);
-          j--;
-        }
-        break;
+        set<BackPack> solutions = solveInteractive(cfg.backPack, cfg.items, SolverOptions(), complete);
+        res.assign(solutions.begin(), solutions.end());
+        if (complete)
+          cache.store(key, res);
       }
-    }
-
-    size = sol1.size() - 2;
-    while (size > 0 && sol1.back().price == sol1[size].price)
-      size--;
-    sol3 = sol1[size + 1];
+      return res;
+    });
+  }
 
-    int min_vol = INT32_MAX;
-    for (auto &backpack: sol2)
+  // Решения по цели: стоимость максимальная, а остальное - в зависимости от варианта
+  vector<BackPack> solve(Variant variant, Selection select, int maxWeight = INT_MAX)
+  {
+    return timed([&]()
     {
-      int vol = 0;
-      for (auto &str: backpack.shape)
+      Objective objective;
+      objective.variant = variant;
+      objective.select = select;
+      objective.maxWeight = maxWeight;
+      vector<BackPack> res;
+      uint64_t key = ResultCache::key(cfg.backPack, cfg.items, "objective", objectiveHash(objective));
+      if (!cache.load(key, res))
       {
-        vol += count(str.begin(), str.end(), '_');
+        if (variant == Variant::A || variant == Variant::B)
+          res = solveObjective(cfg.backPack, cfg.items, objective);
+        else
+        {
+          set<BackPack> solutions = solveInteractive(cfg.backPack, cfg.items, exactOptions(cfg.backPack, cfg.items, objective), complete);
+          res.assign(solutions.begin(), solutions.end());
+        }
+        if (complete)
+          cache.store(key, res);
       }
-      if (vol < min_vol)
-        min_vol=vol;
-    }
+      return res;
+    });
+  }
 
-    for (auto &backpack: sol2) {
-      int vol = 0;
-      for (auto &str: backpack.shape)
+  // Быстрое приближённое решение: стоимость близка к максимальной, вес не превосходит заданной величины
+  BackPack approx()
+  {
+    return timed([this]()
+    {
+      HeuristicOptions heuristic;
+      heuristic.maxWeight = cfg.maxWeight;
+      vector<BackPack> res;
+      uint64_t key = ResultCache::key(cfg.backPack, cfg.items, "heuristic", optionsHash(heuristic));
+      if (!cache.load(key, res) || res.size() != 1)
       {
-        vol += count(str.begin(), str.end(), '_');
+        res = {HeuristicPacker(cfg.backPack, heuristic).solve(cfg.items)};
+        cache.store(key, res);
       }
-      if (vol == min_vol)
-        sol4.emplace_back(backpack);
-    }
+      return res;
+    })[0];
   }
 
   ~AllSolutions() = default;
+
+ private:
+  template<class F>
+  vector<BackPack> timed(F f)
+  {
+    auto begin = chrono::steady_clock::now();
+    complete = true;
+    vector<BackPack> res = f();
+    auto time = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - begin);
+    wcout << "Time: " << time.count() << " mls\n";
+    wcout << "Number of solutions: " << res.size() << "\n";
+    if (!complete)
+      wcout << L"Поиск прерван, решения неполные\n";
+    return res;
+  }
 };
 
 void main_menu2()
 {
   AllSolutions ans;
 
-  auto sol1 = [&ans]()
+  auto print = [](const vector<BackPack> &solutions)
   {
-    for (auto &backpack: ans.sol1)
+    for (auto &backpack: solutions)
     {
       wcout << backpack << "\n";
     }
   };
 
-  auto sol2 = [&ans]()
+  auto sol1 = [&]()
   {
-    for (auto &backpack: ans.sol2)
-    {
-      wcout << backpack << "\n";
-    }
+    print(ans.all());
   };
 
-  auto sol3 = [&ans]()
+  // Вариант c: стоимость максимальная, вес не превосходит заданной величины
+  auto sol2 = [&]()
   {
-    wcout << ans.sol3;
+    print(ans.solve(Variant::C, Selection::Ties, ans.cfg.maxWeight));
   };
 
-  auto sol4 = [&ans]()
+  // Вариант e: стоимость максимальная, а суммарный вес минимальный
+  auto sol3 = [&]()
   {
-    for (auto &backpack: ans.sol4)
-    {
-      wcout << backpack << "\n";
-    }
+    print(ans.solve(Variant::E, Selection::Best));
+  };
+
+  // Вариант d: стоимость максимальная, заполнение максимальное, вес не превосходит заданной величины
+  auto sol4 = [&]()
+  {
+    print(ans.solve(Variant::D, Selection::Ties, ans.cfg.maxWeight));
+  };
+
+  auto approx = [&ans]()
+  {
+    wcout << ans.approx();
   };
 
   MenuItem menu[] = {
@@ -139,13 +217,45 @@ void main_menu2()
       {L"Стоимость максимальная, вес не превосходит заданной величины",sol2},
       {L"Стоимость максимальная, а суммарный вес минимальный", sol3},
       {L"Стоимость максимальная, заполнение максимальное, вес не превосходит заданной величины", sol4},
+      {L"Быстрое приближённое решение (эвристика): стоимость близка к максимальной, вес не превосходит заданной величины", approx},
   };
   menuLoop(L"Возможные операции", _countof(menu), menu);
 }
 
 
+// Часть распределённого перебора: lab3_2 --shard k/N [файл задачи] [файл результата] [контрольная точка]
+// С контрольной точкой прерванный процесс можно запустить заново с теми же аргументами - он продолжит перебор
+int runShard(int argc, char *argv[])
+{
+  ShardSpec spec = ShardSpec::parse(argv[2]);
+  const char *input = argc > 3 ? argv[3] : "../input.txt";
+  string output = argc > 4 ? argv[4] : "shard-" + to_string(spec.index) + "-of-" + to_string(spec.count) + ".txt";
+  string checkpoint = argc > 5 ? argv[5] : "";
+  Config cfg(input);
+  auto begin = chrono::steady_clock::now();
+  ShardFile shard = solveShard(cfg.backPack, cfg.items, spec, {}, checkpoint);
+  writeShard(output, shard);
+  auto time = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - begin);
+  wcout << L"Shard " << spec.index << L"/" << spec.count << L": " << shard.solutions.size() << L" solutions, "
+        << time.count() << L" mls -> " << toWS(output) << endl;
+  return 0;
+}
+
+// Объединение частей: lab3_2 merge файл_части...
+int runMerge(int argc, char *argv[])
+{
+  vector<ShardFile> shards;
+  for (int i = 2; i < argc; i++)
+    shards.push_back(readShard(argv[i]));
+  auto solutions = mergeShards(shards);
+  wcout << "Number of solutions: " << solutions.size() << "\n";
+  for (auto &backpack: solutions)
+    wcout << backpack << "\n";
+  return 0;
+}
+
 // Основная программа
-int main()
+int main(int argc, char *argv[])
 {
   // Задаём кодировку UTF-16 для всего вывода в программе
   // Все символы и строки будут wchar_t
@@ -154,6 +264,23 @@ int main()
   _setmode(_fileno(stdin), _O_U16TEXT);
   _setmode(_fileno(stderr), _O_U16TEXT);
 #endif
+  // Режимы командной строки для распределённого перебора
+  try
+  {
+    if (argc >= 3 && string(argv[1]) == "--shard")
+      return runShard(argc, argv);
+    if (argc >= 3 && string(argv[1]) == "merge")
+      return runMerge(argc, argv);
+  } catch (runtime_error &ex)
+  {
+    wcout << L"Error: " << ex.what() << endl;
+    return 1;
+  } catch (const string &ex)  // Config: нет файла задачи
+  {
+    wcout << L"Error: " << ex.c_str() << endl;
+    return 1;
+  }
+
   wprintf(L"== Задача о рюкзаке ==\n");
 
   // Сделать меню и какие варианты
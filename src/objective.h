@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <set>
+#include <vector>
+
+#include "backpack.h"
+#include "heuristic.h"
+#include "solver.h"
+
+using namespace std;
+
+// Решение по одному из вариантов a-e (см. backpack.h). Вместо перебора всех раскладок с последующим
+// отбором ищется сразу то, что нужно цели: одно лучшее решение, все равные лучшему или k лучших.
+// Варианты c-e - перебор BacktrackSolver с отбором (SolverOptions::select): найденные лучшие решения
+// поднимают границу стоимости, и ветки, которые их не превзойдут, отсекаются. Начальную границу
+// даёт приближённое решение HeuristicPacker (см. exactOptions).
+// В вариантах a и b форма предметов не учитывается, и задача решается динамическим программированием
+
+// Вариант задачи
+enum class Variant { A, B, C, D, E };
+
+// Цель и ограничения
+struct Objective {
+  Variant variant = Variant::C;
+  Selection select = Selection::Best;  // Для a и b всегда одно лучшее решение
+  int k = 1;                           // Количество решений при Selection::TopK
+  int maxWeight = INT_MAX;             // Грузоподъёмность (b, c, d)
+  int maxVolume = -1;                  // Объём в клетках (a, b); -1 - все свободные клетки рюкзака
+  int epsilon = INT_MAX;               // Допуск незаполненного объёма ΔV (c); INT_MAX - без ограничения
+};
+
+// Отпечаток цели (для кэша результатов)
+uint64_t objectiveHash(const Objective &objective) {
+  Fnv1a h;
+  for (long long x : {(long long)objective.variant, (long long)objective.select, (long long)objective.k,
+                      (long long)objective.maxWeight, (long long)objective.maxVolume, (long long)objective.epsilon})
+    h.add(x);
+  return h.value;
+}
+
+// Параметры перебора для вариантов c-e (остальные параметры берутся из options)
+SolverOptions solverOptions(const Objective &objective, SolverOptions options = {}) {
+  options.select = objective.select;
+  options.topK = objective.k;
+  switch (objective.variant) {
+    case Variant::C:
+      // Стоимость максимальная, вес не больше maxWeight, свободных клеток не больше epsilon
+      options.maxWeight = objective.maxWeight;
+      options.tiebreak = Tiebreak::None;
+      if (objective.epsilon != INT_MAX) {
+        options.pruneDeadSpace = true;
+        options.wasteAllowance = objective.epsilon;
+      }
+      break;
+    case Variant::D:
+      // Стоимость максимальная, при равной - заполнение максимальное, вес не больше maxWeight
+      options.maxWeight = objective.maxWeight;
+      options.tiebreak = Tiebreak::MaxFill;
+      break;
+    default:
+      // Стоимость максимальная, при равной - вес минимальный
+      options.tiebreak = Tiebreak::MinWeight;
+      break;
+  }
+  return options;
+}
+
+// Параметры точного перебора для вариантов c-e с начальной границей стоимости: при отборе одного лучшего
+// или всех равных лучшему решения дешевле найденного эвристикой не нужны (SolverOptions::minPrice).
+// Для k лучших и для допуска ΔV граница не ставится: там могут понадобиться и более дешёвые решения
+SolverOptions exactOptions(const BackPack &backPack, const vector<Item *> &items, const Objective &objective,
+                           SolverOptions options = {}) {
+  options = solverOptions(objective, options);
+  if ((options.select != Selection::Best && options.select != Selection::Ties) || options.pruneDeadSpace)
+    return options;
+  HeuristicOptions heuristic;
+  heuristic.maxWeight = options.maxWeight;
+  HeuristicPacker packer(backPack, heuristic);
+  BackPack approx = packer.solve(items);
+  if (packer.found()) options.minPrice = max(options.minPrice, approx.price);
+  return options;
+}
+
+// Варианты a и b: рюкзак 0-1 по объёму (и весу для b), форма предметов игнорируется.
+// Предметы в изображении рюкзака занимают свободные клетки подряд по строкам
+BackPack solveIgnoringShape(const BackPack &backPack, const vector<Item *> &items, const Objective &objective) {
+  BackPack res(backPack.shape, backPack.weight, backPack.price);
+  int n = items.size();
+  vector<int> cells(n, 0);
+  int totalWeight = 0;
+  for (int i = 0; i < n; i++) {
+    for (auto &row : items[i]->shape) cells[i] += count(row.begin(), row.end(), '@');
+    totalWeight += items[i]->weight;
+  }
+  bool byWeight = objective.variant == Variant::B;
+  int volume = objective.maxVolume < 0 ? res.freeCells : objective.maxVolume;
+  int capacity = byWeight ? max(0, min(objective.maxWeight - backPack.weight, totalWeight)) : 0;
+  // best[i][v][w] - наибольшая стоимость первых i предметов объёмом v и весом w (-1 - недостижимо)
+  int layer = (volume + 1) * (capacity + 1);
+  vector<int> best((n + 1) * layer, -1);
+  auto at = [&](int i, int v, int w) -> int & { return best[i * layer + v * (capacity + 1) + w]; };
+  at(0, 0, 0) = 0;
+  for (int i = 0; i < n; i++) {
+    int dw = byWeight ? items[i]->weight : 0;
+    for (int v = 0; v <= volume; v++) {
+      for (int w = 0; w <= capacity; w++) {
+        int current = at(i, v, w);
+        if (current < 0) continue;
+        at(i + 1, v, w) = max(at(i + 1, v, w), current);
+        if (v + cells[i] <= volume && w + dw <= capacity)
+          at(i + 1, v + cells[i], w + dw) = max(at(i + 1, v + cells[i], w + dw), current + items[i]->price);
+      }
+    }
+  }
+  // Лучшая стоимость; при равной - меньший вес, затем меньший объём
+  int bestV = 0, bestW = 0;
+  for (int w = 0; w <= capacity; w++) {
+    for (int v = 0; v <= volume; v++) {
+      if (at(n, v, w) > at(n, bestV, bestW)) bestV = v, bestW = w;
+    }
+  }
+  // Восстановление набора предметов
+  vector<int> chosen;
+  for (int i = n, v = bestV, w = bestW; i > 0; i--) {
+    if (at(i, v, w) == at(i - 1, v, w)) continue;
+    chosen.push_back(i - 1);
+    v -= cells[i - 1];
+    w -= byWeight ? items[i - 1]->weight : 0;
+  }
+  reverse(chosen.begin(), chosen.end());
+  int r = 0, c = 0;
+  for (int i : chosen) {
+    res.weight += items[i]->weight;
+    res.price += items[i]->price;
+    for (int k = 0; k < cells[i]; k++) {
+      while (r < res.shape.size() && (c >= res.shape[r].size() || res.shape[r][c] != '_')) {
+        if (++c >= res.shape[r].size()) r++, c = 0;
+      }
+      if (r < res.shape.size()) res.shape[r][c] = char('1' + i);
+    }
+  }
+  res.countFreeCells();
+  return res;
+}
+
+// Решения по цели в порядке возрастания (стоимость, вес)
+vector<BackPack> solveObjective(const BackPack &backPack, const vector<Item *> &items, const Objective &objective,
+                                const SolverOptions &options = {}) {
+  if (objective.variant == Variant::A || objective.variant == Variant::B)
+    return {solveIgnoringShape(backPack, items, objective)};
+  set<BackPack> solutions = BacktrackSolver(backPack, exactOptions(backPack, items, objective, options)).solve(items);
+  return vector<BackPack>(solutions.begin(), solutions.end());
+}
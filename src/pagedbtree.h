@@ -0,0 +1,253 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+using namespace std;
+
+// Строковый ключ фиксированной длины для хранения на диске.
+// Строка длиннее N байт обрезается, короче - дополняется нулями
+template <int N>
+struct FixedKey {
+  char data[N];
+
+  FixedKey() { memset(data, 0, N); }
+  FixedKey(const string &s) {  // NOLINT: неявное преобразование из строки удобно при поиске
+    memset(data, 0, N);
+    memcpy(data, s.data(), min<size_t>(s.size(), N));
+  }
+  [[nodiscard]] string str() const { return string(data, strnlen(data, N)); }
+
+  friend bool operator<(const FixedKey &a, const FixedKey &b) { return memcmp(a.data, b.data, N) < 0; }
+  friend bool operator==(const FixedKey &a, const FixedKey &b) { return memcmp(a.data, b.data, N) == 0; }
+};
+
+// B-дерево, хранящее узлы в страницах фиксированного размера в отображённом в память файле.
+// Страница 0 - заголовок (сигнатура, версия формата, размер ключа, корень), остальные - узлы.
+// Ключи записываются побайтово, поэтому T должен быть тривиально копируемым (для строк - FixedKey).
+// Кэшем страниц служит страничный кэш ОС: узлы читаются через mmap без копирования,
+// а повторное открытие файла не требует перестроения дерева.
+// Работает только в POSIX-системах
+template <typename T, int PageSize = 4096>
+class PagedBTree {
+  static_assert(is_trivially_copyable_v<T>, "Ключи PagedBTree должны быть тривиально копируемыми");
+  static_assert(alignof(T) <= 8, "Слишком строгое выравнивание ключа");
+
+  static constexpr uint32_t FORMAT_VERSION = 1;
+  static constexpr char MAGIC[8] = {'L', '3', 'B', 'T', 'R', 'E', 'E', 0};
+  // Минимальная степень: 8 байт служебных полей + 2t детей + (2t-1) ключей помещаются в страницу
+  static constexpr int t = int((PageSize - 8 + sizeof(T)) / (2 * (sizeof(T) + 4)));
+  static_assert(t >= 2, "Страница слишком мала для такого ключа");
+  static constexpr int MAX_KEYS = 2 * t - 1;
+
+  // Заголовок файла (страница 0)
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t pageSize;
+    uint32_t keySize;
+    uint32_t root;       // Номер страницы корня, 0 - дерево пустое
+    uint32_t pageCount;  // Количество занятых страниц, включая заголовок
+    uint32_t reserved;
+    uint64_t count;      // Количество ключей
+  };
+
+  // Узел B-дерева в странице
+  struct Node {
+    uint32_t leaf;
+    uint32_t n;
+    uint32_t C[2 * t];  // Номера страниц детей
+    T keys[MAX_KEYS];
+  };
+  static_assert(sizeof(Node) <= PageSize, "Узел не помещается в страницу");
+
+  int fd = -1;
+  char *base = nullptr;   // Начало отображения
+  uint32_t capacity = 0;  // Количество отображённых страниц
+
+  Header *header() const { return reinterpret_cast<Header *>(base); }
+  Node *node(uint32_t page) const { return reinterpret_cast<Node *>(base + size_t(page) * PageSize); }
+
+  // Отобразить файл размером pages страниц
+  void map(uint32_t pages) {
+    if (base != nullptr) munmap(base, size_t(capacity) * PageSize);
+    base = nullptr;
+    if (ftruncate(fd, off_t(pages) * PageSize) != 0) throw runtime_error("PagedBTree: can't resize file");
+    void *p = mmap(nullptr, size_t(pages) * PageSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) throw runtime_error("PagedBTree: mmap failed");
+    base = static_cast<char *>(p);
+    capacity = pages;
+  }
+
+  // Снять отображение и закрыть файл
+  void release() {
+    if (base != nullptr) munmap(base, size_t(capacity) * PageSize);
+    base = nullptr;
+    if (fd >= 0) close(fd);
+    fd = -1;
+  }
+
+  // Прочитать заголовок открытого файла или создать новый
+  void load(const string &fileName) {
+    struct stat st {};
+    if (fstat(fd, &st) != 0) throw runtime_error("PagedBTree: can't stat " + fileName);
+    if (st.st_size == 0) {
+      // Новый файл: заголовок и место под несколько узлов
+      map(16);
+      Header *h = header();
+      memcpy(h->magic, MAGIC, sizeof(MAGIC));
+      h->version = FORMAT_VERSION;
+      h->pageSize = PageSize;
+      h->keySize = sizeof(T);
+      h->root = 0;
+      h->pageCount = 1;
+      h->count = 0;
+      return;
+    }
+    if (st.st_size < PageSize || st.st_size % PageSize != 0)
+      throw runtime_error("PagedBTree: " + fileName + " is not an index file");
+    map(uint32_t(st.st_size / PageSize));
+    Header *h = header();
+    if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != FORMAT_VERSION || h->pageSize != PageSize ||
+        h->keySize != sizeof(T))
+      throw runtime_error("PagedBTree: " + fileName + " has incompatible format");
+  }
+
+  // Выделение новой страницы. Отображение может переместиться - указатели на узлы нужно получить заново
+  uint32_t allocPage(bool leaf) {
+    uint32_t page = header()->pageCount;
+    if (page == capacity) map(capacity * 2);
+    header()->pageCount++;
+    Node *x = node(page);
+    x->leaf = leaf;
+    x->n = 0;
+    return page;
+  }
+
+  // Разделение полного ребенка C[i] узла x
+  void splitChild(uint32_t xPage, int i) {
+    uint32_t zPage = allocPage(node(node(xPage)->C[i])->leaf);
+    Node *x = node(xPage), *y = node(x->C[i]), *z = node(zPage);
+    z->n = t - 1;
+    for (int j = 0; j < t - 1; j++) z->keys[j] = y->keys[j + t];
+    if (!y->leaf) {
+      for (int j = 0; j < t; j++) z->C[j] = y->C[j + t];
+    }
+    y->n = t - 1;
+    for (int j = int(x->n); j >= i + 1; j--) x->C[j + 1] = x->C[j];
+    x->C[i + 1] = zPage;
+    for (int j = int(x->n) - 1; j >= i; j--) x->keys[j + 1] = x->keys[j];
+    x->keys[i] = y->keys[t - 1];
+    x->n++;
+  }
+
+  // Индекс первого ключа >= k
+  static int lowerBound(const Node *x, const T &k) {
+    int lo = 0, hi = int(x->n);
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (x->keys[mid] < k)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+
+  template <class F>
+  void forEach(uint32_t page, F &f) const {
+    const Node *x = node(page);
+    for (int i = 0; i < int(x->n); i++) {
+      if (!x->leaf) forEach(x->C[i], f);
+      f(x->keys[i]);
+    }
+    if (!x->leaf) forEach(x->C[x->n], f);
+  }
+
+ public:
+  // Открыть файл индекса или создать новый.
+  // Существующий файл с чужим форматом или другим размером ключа/страницы - исключение
+  explicit PagedBTree(const string &fileName) {
+    fd = open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) throw runtime_error("PagedBTree: can't open " + fileName);
+    // Деструктор не вызывается, если конструктор выбросил исключение, - освобождаем файл здесь
+    try {
+      load(fileName);
+    } catch (...) {
+      release();
+      throw;
+    }
+  }
+
+  PagedBTree(const PagedBTree &) = delete;
+  PagedBTree &operator=(const PagedBTree &) = delete;
+
+  // Сбрасывает изменения на диск и закрывает файл
+  ~PagedBTree() {
+    sync();
+    release();
+  }
+
+  // Записать изменённые страницы на диск
+  void sync() { msync(base, size_t(capacity) * PageSize, MS_SYNC); }
+
+  // Количество ключей
+  [[nodiscard]] uint64_t size() const { return header()->count; }
+
+  // Есть ли такой ключ в дереве?
+  bool found(const T &k) const {
+    uint32_t page = header()->root;
+    while (page != 0) {
+      const Node *x = node(page);
+      int i = lowerBound(x, k);
+      if (i < int(x->n) && !(k < x->keys[i])) return true;
+      if (x->leaf) return false;
+      page = x->C[i];
+    }
+    return false;
+  }
+
+  // Вставка ключа
+  void insert(const T &k) {
+    if (header()->root == 0) {
+      uint32_t r = allocPage(true);
+      header()->root = r;
+    }
+    // Если корень полный, то дерево увеличивается в высоту
+    if (node(header()->root)->n == MAX_KEYS) {
+      uint32_t s = allocPage(false);
+      node(s)->C[0] = header()->root;
+      splitChild(s, 0);
+      header()->root = s;
+    }
+    // Спуск с разделением полных детей
+    uint32_t page = header()->root;
+    while (!node(page)->leaf) {
+      int i = lowerBound(node(page), k);
+      if (node(node(page)->C[i])->n == MAX_KEYS) {
+        splitChild(page, i);
+        if (node(page)->keys[i] < k) i++;
+      }
+      page = node(page)->C[i];
+    }
+    Node *x = node(page);
+    int i = lowerBound(x, k);
+    for (int j = int(x->n); j > i; j--) x->keys[j] = x->keys[j - 1];
+    x->keys[i] = k;
+    x->n++;
+    header()->count++;
+  }
+
+  // Обход всех ключей по возрастанию
+  template <class F>
+  void forEach(F f) const {
+    if (header()->root != 0) forEach(header()->root, f);
+  }
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Размер последовательности, начиная с которого map/where/reduce выполняются параллельно
+const int PARALLEL_THRESHOLD = 1 << 14;
+
+// Пул потоков для параллельной обработки кусков (chunks) диапазона индексов
+class ThreadPool {
+  vector<thread> workers;
+  queue<function<void()>> tasks;
+  mutex m;
+  condition_variable cv;
+  bool stopping = false;
+
+  void workerLoop() {
+    while (true) {
+      function<void()> task;
+      {
+        unique_lock<mutex> lock(m);
+        cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+        if (stopping && tasks.empty()) return;
+        task = std::move(tasks.front());
+        tasks.pop();
+      }
+      task();
+    }
+  }
+
+ public:
+  // threads - количество рабочих потоков (вызывающий поток тоже участвует в работе)
+  explicit ThreadPool(int threads) {
+    for (int i = 0; i < threads; i++) workers.emplace_back([this]() { workerLoop(); });
+  }
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ~ThreadPool() {
+    {
+      lock_guard<mutex> lock(m);
+      stopping = true;
+    }
+    cv.notify_all();
+    for (auto &w : workers) w.join();
+  }
+
+  // Общий пул: по потоку на ядро, кроме вызывающего (но хотя бы один)
+  static ThreadPool &global() {
+    static ThreadPool pool(max(2, int(thread::hardware_concurrency())) - 1);
+    return pool;
+  }
+
+  // Количество потоков, выполняющих работу (рабочие + вызывающий)
+  [[nodiscard]] int concurrency() const { return int(workers.size()) + 1; }
+
+  // Выполнить f(chunk, begin, end) для кусков диапазона [0, n) и дождаться завершения всех.
+  // Куски разбираются потоками по мере освобождения; исключение из f передаётся вызывающему
+  template <class F>
+  void parallelFor(int n, int chunks, F f) {
+    if (n <= 0) return;
+    chunks = max(1, min(chunks, n));
+    struct State {
+      atomic<int> next{0};
+      int done = 0;
+      exception_ptr error;
+      mutex m;
+      condition_variable finished;
+    };
+    auto state = make_shared<State>();
+    // Обработка кусков, пока они не кончатся
+    auto run = [state, n, chunks, &f]() {
+      int c;
+      while ((c = state->next.fetch_add(1)) < chunks) {
+        try {
+          f(c, int(int64_t(n) * c / chunks), int(int64_t(n) * (c + 1) / chunks));
+        } catch (...) {
+          lock_guard<mutex> lock(state->m);
+          if (!state->error) state->error = current_exception();
+        }
+        lock_guard<mutex> lock(state->m);
+        if (++state->done == chunks) state->finished.notify_all();
+      }
+    };
+    {
+      lock_guard<mutex> lock(m);
+      for (int i = 0; i < min(int(workers.size()), chunks - 1); i++) tasks.emplace(run);
+    }
+    cv.notify_all();
+    run();
+    unique_lock<mutex> lock(state->m);
+    state->finished.wait(lock, [&]() { return state->done == chunks; });
+    if (state->error) rethrow_exception(state->error);
+  }
+
+  // Количество кусков для диапазона из n элементов: несколько на поток для балансировки
+  [[nodiscard]] int chunksFor(int n) const { return min(concurrency() * 4, max(1, n / 1024)); }
+};
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "backpack.h"
+
+using namespace std;
+
+// Фигуры как битовые маски. Таблица поворотов (compileShape) строится constexpr-функциями,
+// поэтому для встроенного каталога фигур она вычисляется при компиляции:
+//   constexpr auto kocherga = compileShape({"@@@", " @ ", "@@@"});
+// Повороты нормализованы (фигура обрезана по описывающему прямоугольнику), без повторов и идут
+// в том же порядке, что и изображения в genAllRotations. Для фигур без пустых крайних строк
+// и столбцов таблица совпадает с genAllRotations
+
+// Поворот фигуры: строка r описывающего прямоугольника - биты 8r..8r+7, столбец c - бит c в строке.
+// Фигура не больше 8x8
+struct ShapeMask {
+  int height = 0, width = 0;
+  uint64_t bits = 0;
+
+  [[nodiscard]] constexpr unsigned row(int r) const { return unsigned(bits >> (8 * r)) & 0xFFu; }
+  [[nodiscard]] constexpr bool cell(int r, int c) const { return (bits >> (8 * r + c)) & 1u; }
+  constexpr void set(int r, int c) { bits |= uint64_t(1) << (8 * r + c); }
+
+  [[nodiscard]] constexpr int cells() const {
+    int n = 0;
+    for (uint64_t b = bits; b; b &= b - 1) n++;
+    return n;
+  }
+
+  // Поворот на 90° (как rotate)
+  [[nodiscard]] constexpr ShapeMask rotated() const {
+    ShapeMask res{width, height, 0};
+    for (int i = 0; i < width; i++) {
+      for (int j = 0; j < height; j++) {
+        if (cell(height - j - 1, i)) res.set(i, j);
+      }
+    }
+    return res;
+  }
+
+  // Отражение слева направо (как mirror)
+  [[nodiscard]] constexpr ShapeMask mirrored() const {
+    ShapeMask res{height, width, 0};
+    for (int i = 0; i < height; i++) {
+      for (int j = 0; j < width; j++) {
+        if (cell(i, width - j - 1)) res.set(i, j);
+      }
+    }
+    return res;
+  }
+
+  // Сдвиг в левый верхний угол и обрезка по описывающему прямоугольнику
+  [[nodiscard]] constexpr ShapeMask normalized() const {
+    int top = height, left = width, bottom = -1, right = -1;
+    for (int r = 0; r < height; r++) {
+      for (int c = 0; c < width; c++) {
+        if (!cell(r, c)) continue;
+        top = r < top ? r : top;
+        left = c < left ? c : left;
+        bottom = r > bottom ? r : bottom;
+        right = c > right ? c : right;
+      }
+    }
+    if (bottom < 0) throw runtime_error("Shape has no cells");
+    ShapeMask res{bottom - top + 1, right - left + 1, 0};
+    for (int r = top; r <= bottom; r++) {
+      for (int c = left; c <= right; c++) {
+        if (cell(r, c)) res.set(r - top, c - left);
+      }
+    }
+    return res;
+  }
+
+  // Порядок изображений Shape (строки из ' ' и '@' сравниваются как строки)
+  constexpr bool operator<(const ShapeMask &o) const {
+    for (int r = 0; r < height && r < o.height; r++) {
+      for (int c = 0; c < width && c < o.width; c++) {
+        if (cell(r, c) != o.cell(r, c)) return o.cell(r, c);  // ' ' < '@'
+      }
+      if (width != o.width) return width < o.width;
+    }
+    return height < o.height;
+  }
+  constexpr bool operator==(const ShapeMask &o) const {
+    return height == o.height && width == o.width && bits == o.bits;
+  }
+
+  // Изображение поворота
+  [[nodiscard]] Shape toShape() const {
+    Shape res(height, string(width, ' '));
+    for (int r = 0; r < height; r++) {
+      for (int c = 0; c < width; c++) {
+        if (cell(r, c)) res[r][c] = '@';
+      }
+    }
+    return res;
+  }
+};
+
+// Все повороты и отражения фигуры, без повторов, в порядке ShapeMask::operator<
+struct OrientationTable {
+  ShapeMask masks[8]{};
+  int count = 0;
+  int cells = 0;  // Клеток в фигуре
+
+  [[nodiscard]] constexpr const ShapeMask &operator[](int i) const { return masks[i]; }
+  [[nodiscard]] constexpr const ShapeMask *begin() const { return masks; }
+  [[nodiscard]] constexpr const ShapeMask *end() const { return masks + count; }
+};
+
+constexpr OrientationTable orientations(const ShapeMask &shape) {
+  ShapeMask all[8]{};
+  all[0] = shape.normalized();
+  all[1] = all[0].mirrored();
+  for (int i = 2; i < 8; i++) all[i] = all[i - 2].rotated();
+  // Сортировка вставками и удаление повторов
+  for (int i = 1; i < 8; i++) {
+    ShapeMask x = all[i];
+    int j = i;
+    for (; j > 0 && x < all[j - 1]; j--) all[j] = all[j - 1];
+    all[j] = x;
+  }
+  OrientationTable table;
+  for (auto &mask : all) {
+    if (table.count == 0 || !(table.masks[table.count - 1] == mask)) table.masks[table.count++] = mask;
+  }
+  table.cells = all[0].cells();
+  return table;
+}
+
+// Разбор изображения: '@' - клетка фигуры. Может выбрасывать исключения: runtime_error (фигура больше 8x8)
+template <size_t N>
+constexpr ShapeMask parseShape(const char *const (&rows)[N]) {
+  if (N > 8) throw runtime_error("Shape is larger than 8x8");
+  ShapeMask res{int(N), 0, 0};
+  for (int r = 0; r < int(N); r++) {
+    for (int c = 0; rows[r][c] != '\0'; c++) {
+      if (c >= 8) throw runtime_error("Shape is larger than 8x8");
+      if (rows[r][c] == '@') res.set(r, c);
+      res.width = c + 1 > res.width ? c + 1 : res.width;
+    }
+  }
+  return res;
+}
+
+ShapeMask parseShape(const Shape &shape) {
+  if (shape.size() > 8) throw runtime_error("Shape is larger than 8x8");
+  ShapeMask res{int(shape.size()), 0, 0};
+  for (int r = 0; r < shape.size(); r++) {
+    if (shape[r].size() > 8) throw runtime_error("Shape is larger than 8x8");
+    for (int c = 0; c < shape[r].size(); c++) {
+      if (shape[r][c] == '@') res.set(r, c);
+    }
+    res.width = max(res.width, int(shape[r].size()));
+  }
+  return res;
+}
+
+template <size_t N>
+constexpr OrientationTable compileShape(const char *const (&rows)[N]) {
+  return orientations(parseShape(rows));
+}
+
+OrientationTable compileShape(const Shape &shape) { return orientations(parseShape(shape)); }
+
+// Предмет каталога: вес, стоимость и готовая таблица поворотов
+struct CatalogItem {
+  int weight;
+  int price;
+  OrientationTable table;
+};
+
+// Перебор с возвратом для рюкзака фиксированного размера Rows x Cols: строка рюкзака - битовая маска,
+// проверка и укладка поворота - по одной операции на каждую из 8 строк маски фигуры.
+// Все границы циклов - константы времени компиляции: перебираются все Rows x Cols клеток привязки,
+// а фигура, выходящая за сетку, отсекается занятыми битами за её пределами (столбцы Cols..63
+// и 7 строк после последней). Обход и результат те же, что у BacktrackSolver без параметров
+// (привязка к клетке '#' пропускается, как в исходном переборе); с maxWeight отбрасываются ветки с перевесом.
+// Изображение рюкзака строится только для новой пары (стоимость, вес)
+template <int Rows, int Cols>
+class FixedGridSolver {
+  // Строка фигуры (до 8 клеток), привязанная к последнему столбцу, должна остаться в 64-битной маске
+  static_assert(Rows > 0 && Cols > 0 && Cols <= 56, "Backpack rows and shape overhang must fit into 64-bit masks");
+
+ public:
+  // Может выбрасывать исключения: runtime_error (рюкзак больше Rows x Cols)
+  explicit FixedGridSolver(const BackPack &bp, int maxWeight = INT_MAX) : backPack(bp), maxWeight(maxWeight) {
+    if (bp.shape.size() > Rows) throw runtime_error("Backpack has more than " + to_string(Rows) + " rows");
+    for (int r = 0; r < Rows; r++) {
+      walls[r] = occupied[r] = ~uint64_t(0) << (Cols - 1) << 1;  // Биты за пределами сетки
+      if (r >= bp.shape.size()) {
+        walls[r] = occupied[r] = ~uint64_t(0);
+        continue;
+      }
+      const string &row = bp.shape[r];
+      if (row.size() > Cols) throw runtime_error("Backpack has more than " + to_string(Cols) + " columns");
+      for (int c = 0; c < Cols; c++) {
+        uint64_t bit = uint64_t(1) << c;
+        if (c >= row.size() || row[c] == '#') walls[r] |= bit;
+        if (c >= row.size() || row[c] != '_') occupied[r] |= bit;
+      }
+    }
+    for (int r = Rows; r < Rows + 7; r++) occupied[r] = ~uint64_t(0);
+  }
+
+  set<BackPack> solve(const vector<CatalogItem> &source) {
+    if (source.size() > 64) throw runtime_error("Too many items");
+    items = &source;
+    used = 0;
+    weight = backPack.weight;
+    price = backPack.price;
+    freeCells = backPack.freeCells;
+    explored = 1;
+    path.clear();
+    set<BackPack> solutions;
+    search(solutions);
+    return solutions;
+  }
+
+  // Таблицы поворотов строятся при вызове (для предметов, прочитанных из файла)
+  set<BackPack> solve(const vector<Item *> &source) {
+    vector<CatalogItem> compiled;
+    for (auto *item : source) compiled.push_back({item->weight, item->price, compileShape(item->shape)});
+    return solve(compiled);
+  }
+
+  // Количество рассмотренных состояний при последнем solve
+  [[nodiscard]] long long nodes() const { return explored; }
+
+ private:
+  struct Placement {
+    int item;
+    const ShapeMask *mask;
+    int row, col;
+  };
+
+  BackPack backPack;
+  int maxWeight;
+  uint64_t walls[Rows];     // Клетки '#' (и за пределами рюкзака)
+  uint64_t occupied[Rows + 7];  // Все клетки, кроме свободных; 7 строк за сеткой заняты
+  const vector<CatalogItem> *items = nullptr;
+  uint64_t used = 0;
+  int weight = 0, price = 0, freeCells = 0;
+  long long explored = 0;
+  vector<Placement> path;
+
+  // Строки маски за высотой фигуры пустые, поэтому цикл всегда на 8 строк
+  bool fits(const ShapeMask &m, int row, int col) const {
+    uint64_t conflict = 0;
+    for (int r = 0; r < 8; r++) conflict |= (uint64_t(m.row(r)) << col) & occupied[row + r];
+    return conflict == 0;
+  }
+
+  void toggle(const ShapeMask &m, int row, int col) {
+    for (int r = 0; r < 8; r++) occupied[row + r] ^= uint64_t(m.row(r)) << col;
+  }
+
+  void snapshot(set<BackPack> &solutions) {
+    if (solutions.count(BackPack({}, weight, price))) return;
+    vector<string> grid = backPack.shape;
+    for (auto &p : path) {
+      for (int r = 0; r < p.mask->height; r++) {
+        for (int c = 0; c < p.mask->width; c++) {
+          if (p.mask->cell(r, c)) grid[p.row + r][p.col + c] = char('1' + p.item);
+        }
+      }
+    }
+    solutions.insert(BackPack(grid, weight, price, freeCells));
+  }
+
+  void search(set<BackPack> &solutions) {
+    bool hasChild = false;
+    int n = items->size();
+    for (int i = 0; i < n; i++) {
+      if ((used >> i) & 1) continue;
+      const CatalogItem &item = (*items)[i];
+      for (const ShapeMask &m : item.table) {
+        for (int row = 0; row < Rows; row++) {
+          for (int col = 0; col < Cols; col++) {
+            if ((walls[row] >> col) & 1 || !fits(m, row, col)) continue;
+            hasChild = true;
+            explored++;
+            toggle(m, row, col);
+            path.push_back({i, &m, row, col});
+            used |= uint64_t(1) << i;
+            weight += item.weight;
+            price += item.price;
+            freeCells -= item.table.cells;
+            if (weight <= maxWeight) {
+              if (path.size() == n)
+                snapshot(solutions);
+              else
+                search(solutions);
+            }
+            freeCells += item.table.cells;
+            price -= item.price;
+            weight -= item.weight;
+            used &= ~(uint64_t(1) << i);
+            path.pop_back();
+            toggle(m, row, col);
+          }
+        }
+      }
+    }
+    if (!hasChild) snapshot(solutions);
+  }
+};
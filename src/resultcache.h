@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "backpack.h"
+
+using namespace std;
+
+// Версия ответов решателей. Увеличивается при каждом изменении, после которого решатели
+// (solver.h, objective.h, heuristic.h) могут вернуть другой ответ на ту же задачу
+const int RESULTS_VERSION = 2;  // 2: вариант d возвращает самую полную раскладку для каждой пары
+
+// Кэш результатов на диске: каталог с файлами вида <ключ>.l3c.
+// Ключ - хэш содержимого задачи (рюкзак и предметы), цели (какой ответ считаем) и параметров решателя,
+// поэтому изменённый файл задачи или другие параметры дают другой ключ. В ключ входит и версия алгоритмов
+// (RESULTS_VERSION): после изменения того, что возвращают решатели, старые записи больше не находятся.
+// Файл другой версии формата или с другим ключом внутри считается отсутствующим.
+// Размер каталога ограничен: при превышении удаляются давно не использованные файлы
+// (время использования - время изменения файла, оно обновляется при каждом чтении).
+// Кэш необязателен: любые ошибки файловой системы означают просто промах
+class ResultCache {
+  filesystem::path dir;
+  uintmax_t maxBytes;
+
+  static constexpr const char *MAGIC = "L3CACHE";
+  static constexpr int VERSION = 1;
+
+  [[nodiscard]] filesystem::path fileFor(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.l3c", (unsigned long long)key);
+    return dir / name;
+  }
+
+  // Удалить самые старые файлы, пока каталог больше maxBytes
+  void evict() {
+    error_code ec;
+    vector<pair<filesystem::file_time_type, filesystem::path>> files;
+    uintmax_t total = 0;
+    for (auto &entry : filesystem::directory_iterator(dir, ec)) {
+      if (entry.path().extension() != ".l3c") continue;
+      uintmax_t size = entry.file_size(ec);
+      if (ec) continue;
+      total += size;
+      files.emplace_back(entry.last_write_time(ec), entry.path());
+    }
+    sort(files.begin(), files.end());
+    for (auto &file : files) {
+      if (total <= maxBytes) break;
+      uintmax_t size = filesystem::file_size(file.second, ec);
+      if (filesystem::remove(file.second, ec)) total -= size;
+    }
+  }
+
+ public:
+  // Каталог по умолчанию: переменная окружения LAB3_CACHE_DIR или .lab3_cache в текущем каталоге
+  static string defaultDir() {
+    const char *env = getenv("LAB3_CACHE_DIR");
+    return env && *env ? env : ".lab3_cache";
+  }
+
+  explicit ResultCache(const string &dir = defaultDir(), uintmax_t maxBytes = 64 << 20) : dir(dir), maxBytes(maxBytes) {}
+
+  // Ключ кэша: версия алгоритмов + задача + цель (например, "all") + отпечаток параметров решателя
+  static uint64_t key(const BackPack &bp, const vector<Item *> &items, const string &objective, uint64_t options) {
+    Fnv1a h;
+    h.add(RESULTS_VERSION);
+    h.add((long long)instanceHash(bp, items));
+    h.add(objective);
+    h.add((long long)options);
+    return h.value;
+  }
+
+  // Прочитать результат. false - промах (нет файла, другая версия, повреждён)
+  bool load(uint64_t key, vector<BackPack> &result) {
+    auto file = fileFor(key);
+    ifstream in(file);
+    if (!in.is_open()) return false;
+    string magic;
+    int version = 0;
+    unsigned long long storedKey = 0;
+    size_t n = 0;
+    if (!(in >> magic >> version >> storedKey >> n) || magic != MAGIC || version != VERSION || storedKey != key)
+      return false;
+    vector<BackPack> res(n);
+    for (auto &bp : res) {
+      int rows = 0;
+      if (!(in >> bp.price >> bp.weight >> rows)) return false;
+      string line;
+      getline(in, line);
+      for (int r = 0; r < rows; r++) {
+        if (!getline(in, line)) return false;
+        bp.shape.push_back(line);
+      }
+      bp.countFreeCells();
+    }
+    result = std::move(res);
+    error_code ec;
+    filesystem::last_write_time(file, filesystem::file_time_type::clock::now(), ec);  // Отметка использования
+    return true;
+  }
+
+  // Сохранить результат и при необходимости освободить место
+  void store(uint64_t key, const vector<BackPack> &result) {
+    error_code ec;
+    filesystem::create_directories(dir, ec);
+    auto file = fileFor(key);
+    auto tmp = file;
+    tmp += ".tmp";
+    {
+      ofstream out(tmp, ios::trunc);
+      if (!out.is_open()) return;
+      out << MAGIC << " " << VERSION << " " << (unsigned long long)key << " " << result.size() << "\n";
+      for (auto &bp : result) {
+        out << bp.price << " " << bp.weight << " " << bp.shape.size() << "\n";
+        for (auto &row : bp.shape) out << row << "\n";
+      }
+      if (!out) {
+        out.close();
+        filesystem::remove(tmp, ec);
+        return;
+      }
+    }
+    filesystem::rename(tmp, file, ec);
+    evict();
+  }
+
+  // Удалить все записи
+  void clear() {
+    error_code ec;
+    for (auto &entry : filesystem::directory_iterator(dir, ec)) {
+      if (entry.path().extension() == ".l3c") filesystem::remove(entry.path(), ec);
+    }
+  }
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "arraysequence.h"
+#include "common.hpp"
+#include "sequence.h"
+
+// == Ленивые представления последовательностей ==
+// view(seq).map(f).where(h).reduce(g) не создаёт промежуточных последовательностей:
+// все этапы сливаются в один проход по исходным данным, а функции передаются как шаблонные
+// параметры (лямбды), поэтому компилятор может их встроить.
+// Результат материализуется только по запросу - toSequence()
+
+// Общие операции над представлениями (CRTP). Derived должен определять
+// value_type и forEach(sink), где sink возвращает false, если обход нужно прекратить
+template <class Derived>
+class ViewOps {
+  const Derived &self() const { return static_cast<const Derived &>(*this); }
+
+ public:
+  // Применение функции f к каждому элементу (лениво)
+  template <class F>
+  auto map(F f) const;
+  // Фильтрация элементов функцией h (лениво)
+  template <class H>
+  auto where(H h) const;
+
+  // Свёртка: применяем f к каждой паре значений пока не получим одно значение.
+  // Может выбрасывать исключения: IndexOutOfRange (если элементов нет)
+  template <class F>
+  auto reduce(F f) const {
+    using V = typename Derived::value_type;
+    bool first = true;
+    V result{};
+    self().forEach([&](V x) {
+      if (first) {
+        result = std::move(x);
+        first = false;
+      } else {
+        result = f(std::move(result), std::move(x));
+      }
+      return true;
+    });
+    if (first) throw IndexOutOfRange("reduce of empty view");
+    return result;
+  }
+  // Свёртка с начальным значением
+  template <class F, class V>
+  V reduce(F f, V init) const {
+    self().forEach([&](auto &&x) {
+      init = f(std::move(init), std::forward<decltype(x)>(x));
+      return true;
+    });
+    return init;
+  }
+  // Количество элементов (проход по источнику)
+  [[nodiscard]] int count() const {
+    int n = 0;
+    self().forEach([&n](auto &&) {
+      n++;
+      return true;
+    });
+    return n;
+  }
+  // Вызов f для каждого элемента
+  template <class F>
+  void each(F f) const {
+    self().forEach([&f](auto &&x) {
+      f(std::forward<decltype(x)>(x));
+      return true;
+    });
+  }
+  // Материализация в новую последовательность на основе массива
+  template <class D = Derived>
+  Sequence<typename D::value_type> *toSequence() const {
+    auto *res = new ArraySequence<typename D::value_type>();
+    self().forEach([res](auto &&x) {
+      res->append(std::forward<decltype(x)>(x));
+      return true;
+    });
+    return res;
+  }
+};
+
+// Источник - существующая последовательность (элементы не копируются заранее)
+template <class T>
+class SequenceView : public ViewOps<SequenceView<T>> {
+  const Sequence<T> &seq;
+
+ public:
+  using value_type = T;
+  explicit SequenceView(const Sequence<T> &seq) : seq(seq) {}
+
+  template <class Sink>
+  bool forEach(Sink &&sink) const {
+    int n = seq.getLength();
+    for (int i = 0; i < n; i++) {
+      if (!sink(seq.get(i))) return false;
+    }
+    return true;
+  }
+};
+
+// Этап map
+template <class Source, class F>
+class MapView : public ViewOps<MapView<Source, F>> {
+  Source source;
+  F f;
+
+ public:
+  using value_type = decay_t<invoke_result_t<F &, typename Source::value_type>>;
+  MapView(Source source, F f) : source(std::move(source)), f(std::move(f)) {}
+
+  template <class Sink>
+  bool forEach(Sink &&sink) const {
+    return source.forEach([&](auto &&x) { return sink(f(std::forward<decltype(x)>(x))); });
+  }
+};
+
+// Этап where
+template <class Source, class H>
+class WhereView : public ViewOps<WhereView<Source, H>> {
+  Source source;
+  H h;
+
+ public:
+  using value_type = typename Source::value_type;
+  WhereView(Source source, H h) : source(std::move(source)), h(std::move(h)) {}
+
+  template <class Sink>
+  bool forEach(Sink &&sink) const {
+    return source.forEach([&](auto &&x) { return !h(x) || sink(std::forward<decltype(x)>(x)); });
+  }
+};
+
+template <class Derived>
+template <class F>
+auto ViewOps<Derived>::map(F f) const {
+  return MapView<Derived, F>(self(), std::move(f));
+}
+
+template <class Derived>
+template <class H>
+auto ViewOps<Derived>::where(H h) const {
+  return WhereView<Derived, H>(self(), std::move(h));
+}
+
+// Ленивое представление последовательности: view(seq).map(...).where(...).reduce(...)
+template <class T>
+SequenceView<T> view(const Sequence<T> &seq) {
+  return SequenceView<T>(seq);
+}
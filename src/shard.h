@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "backpack.h"
+#include "solver.h"
+
+using namespace std;
+
+// Распределённый перебор несколькими процессами (в том числе на разных машинах с общей файловой системой).
+// Каждый процесс запускается с --shard k/N, перебирает свою часть ходов первого уровня
+// (см. SolverOptions::shard) и записывает найденные решения в файл. Команда merge объединяет файлы
+// всех частей; результат совпадает с перебором в одном процессе, включая выбор раскладки
+// для каждой пары (стоимость, вес): остаётся решение из ветки с меньшим номером хода первого уровня.
+// Файл части хранит отпечатки задачи и параметров перебора, и merge не смешивает части разных задач
+
+// Номер части и количество частей
+struct ShardSpec {
+  int index = 0;  // k - номер части, 0 <= k < N
+  int count = 1;  // N - количество частей
+
+  // Разбор строки вида "k/N". Может выбрасывать исключения: runtime_error (неверный формат)
+  static ShardSpec parse(const string &text) {
+    ShardSpec spec;
+    char slash = 0, rest = 0;
+    if (sscanf(text.c_str(), "%d%c%d%c", &spec.index, &slash, &spec.count, &rest) != 3 || slash != '/' ||
+        spec.count < 1 || spec.index < 0 || spec.index >= spec.count)
+      throw runtime_error("Invalid shard '" + text + "', expected k/N with 0 <= k < N");
+    return spec;
+  }
+};
+
+// Решение части вместе с номером хода первого уровня, в ветке которого оно найдено
+struct ShardSolution {
+  BackPack bp;
+  int origin;
+};
+
+// Содержимое файла части
+struct ShardFile {
+  ShardSpec spec;
+  vector<ShardSolution> solutions;
+  uint64_t instance = 0;  // Отпечаток задачи (instanceHash)
+  uint64_t settings = 0;  // Отпечаток параметров перебора без номера части (optionsHash)
+};
+
+const char *const SHARD_MAGIC = "L3SHARD";
+const int SHARD_VERSION = 2;
+
+// Отпечаток параметров, общий для всех частей одного перебора
+uint64_t shardOptionsHash(SolverOptions options) {
+  options.shard = 0;
+  options.shards = 1;
+  return optionsHash(options);
+}
+
+// Перебор части spec: решения и номера ходов первого уровня.
+// Если задан checkpointFile, перебор периодически сохраняет контрольную точку и, если файл
+// уже есть (процесс был прерван), продолжает с неё
+ShardFile solveShard(const BackPack &backPack, const vector<Item *> &items, ShardSpec spec, SolverOptions options = {},
+                     const string &checkpointFile = "") {
+  options.shard = spec.index;
+  options.shards = spec.count;
+  BacktrackSolver solver(backPack, options);
+  set<BackPack> solutions;
+  if (checkpointFile.empty()) {
+    solutions = solver.solve(items);
+  } else {
+    solver.enableCheckpoints(checkpointFile, chrono::seconds(30));
+    solutions = ifstream(checkpointFile).good() ? solver.resume(items) : solver.solve(items);
+  }
+  ShardFile res{spec, {}, instanceHash(backPack, items), shardOptionsHash(options)};
+  for (auto &bp : solutions) res.solutions.push_back({bp, solver.origin(bp)});
+  return res;
+}
+
+// Запись файла части. Пишем во временный файл и переименовываем,
+// чтобы merge никогда не увидел недописанный файл
+void writeShard(const string &fileName, const ShardFile &shard) {
+  string tmp = fileName + ".tmp";
+  {
+    ofstream out(tmp, ios::trunc);
+    if (!out.is_open()) throw runtime_error("Can't write file " + tmp);
+    out << SHARD_MAGIC << " " << SHARD_VERSION << " " << shard.instance << " " << shard.settings << "\n";
+    out << shard.spec.index << " " << shard.spec.count << " " << shard.solutions.size() << "\n";
+    for (auto &s : shard.solutions) {
+      out << s.bp.price << " " << s.bp.weight << " " << s.origin << " " << s.bp.shape.size() << "\n";
+      for (auto &row : s.bp.shape) out << row << "\n";
+    }
+    if (!out) throw runtime_error("Can't write file " + tmp);
+  }
+  if (rename(tmp.c_str(), fileName.c_str()) != 0) throw runtime_error("Can't rename " + tmp + " to " + fileName);
+}
+
+// Чтение файла части. Может выбрасывать исключения: runtime_error (нет файла или неверный формат)
+ShardFile readShard(const string &fileName) {
+  ifstream in(fileName);
+  if (!in.is_open()) throw runtime_error("Can't open file " + fileName);
+  string magic;
+  int version = 0, n = 0;
+  ShardFile res;
+  if (!(in >> magic >> version) || magic != SHARD_MAGIC || version != SHARD_VERSION ||
+      !(in >> res.instance >> res.settings >> res.spec.index >> res.spec.count >> n) || n < 0)
+    throw runtime_error("File " + fileName + " is not a shard file");
+  // Те же ограничения, что и в ShardSpec::parse
+  if (res.spec.count < 1 || res.spec.index < 0 || res.spec.index >= res.spec.count)
+    throw runtime_error("Invalid shard " + to_string(res.spec.index) + "/" + to_string(res.spec.count) + " in file " +
+                        fileName);
+  for (int i = 0; i < n; i++) {
+    ShardSolution s{};
+    int rows = 0;
+    if (!(in >> s.bp.price >> s.bp.weight >> s.origin >> rows)) throw runtime_error("Truncated shard file " + fileName);
+    string line;
+    getline(in, line);
+    for (int r = 0; r < rows; r++) {
+      if (!getline(in, line)) throw runtime_error("Truncated shard file " + fileName);
+      s.bp.shape.push_back(line);
+    }
+    s.bp.countFreeCells();
+    res.solutions.push_back(std::move(s));
+  }
+  return res;
+}
+
+// Объединение частей: должны быть все части 0..N-1 ровно по одному разу, от одной задачи с одними параметрами.
+// Для каждой пары (стоимость, вес) остаётся решение с наименьшим номером хода первого уровня.
+// Может выбрасывать исключения: runtime_error (части не согласованы)
+set<BackPack> mergeShards(const vector<ShardFile> &shards) {
+  if (shards.empty()) throw runtime_error("No shards to merge");
+  int count = shards[0].spec.count;
+  vector<char> seen(count, 0);
+  for (auto &shard : shards) {
+    if (shard.spec.count != count) throw runtime_error("Shards come from different partitions");
+    if (shard.spec.index < 0 || shard.spec.index >= count)
+      throw runtime_error("Invalid shard " + to_string(shard.spec.index) + "/" + to_string(count));
+    if (shard.instance != shards[0].instance) throw runtime_error("Shards come from different tasks");
+    if (shard.settings != shards[0].settings) throw runtime_error("Shards come from different solver options");
+    if (seen[shard.spec.index]++) throw runtime_error("Shard " + to_string(shard.spec.index) + " is given twice");
+  }
+  for (int k = 0; k < count; k++) {
+    if (!seen[k]) throw runtime_error("Shard " + to_string(k) + "/" + to_string(count) + " is missing");
+  }
+  map<pair<int, int>, const ShardSolution *> best;
+  for (auto &shard : shards) {
+    for (auto &s : shard.solutions) {
+      auto &slot = best[{s.bp.price, s.bp.weight}];
+      if (slot == nullptr || s.origin < slot->origin) slot = &s;
+    }
+  }
+  set<BackPack> res;
+  for (auto &entry : best) res.insert(entry.second->bp);
+  return res;
+}
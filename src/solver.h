@@ -0,0 +1,549 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "backpack.h"
+#include "checkpoint.h"
+
+using namespace std;
+
+// Перебор с возвратом (backtracking) по тому же дереву решений, что и SolutionTree,
+// но без построения узлов: рюкзак - одна изменяемая сетка, предмет кладётся в неё на месте,
+// а занятые клетки записываются в стек отмены и освобождаются при возврате.
+// Порядок обхода (предметы, повороты из genAllRotations, строки, столбцы) совпадает с SolutionTree,
+// поэтому множество решений и выбранные для каждого (стоимость, вес) раскладки получаются те же.
+// Копия сетки делается только для листа с новой парой (стоимость, вес)
+
+// Какие решения оставлять
+enum class Selection {
+  All,   // Все решения (по одному на пару (стоимость, вес))
+  Best,  // Одно лучшее
+  Ties,  // Все решения, равные лучшему
+  TopK,  // topK лучших
+};
+
+// Порядок решений при отборе: сначала стоимость (больше - лучше), затем
+enum class Tiebreak {
+  None,       // больше ничего не сравнивается
+  MaxFill,    // меньше свободных клеток
+  MinWeight,  // меньше вес
+};
+
+// Параметры поиска
+struct SolverOptions {
+  // Отсечение по мёртвому пространству: после каждой укладки свободные клетки разбиваются
+  // на связные области, и области меньше самого маленького из оставшихся предметов считаются
+  // потерянными навсегда. Ветка отсекается, как только потери превышают допуск,
+  // а в решения попадают только листья, где свободных клеток не больше допуска
+  bool pruneDeadSpace = false;
+  int wasteAllowance = 0;  // Допуск ΔV (вариант c: 0 - рюкзак заполнен полностью)
+  // Вариант d: допуск - число свободных клеток лучшего найденного решения;
+  // при улучшении заполнения худшие решения удаляются
+  bool incumbentAllowance = false;
+  // Ветки и решения с весом больше maxWeight отбрасываются
+  int maxWeight = INT_MAX;
+  // Нижняя граница стоимости (например, стоимость решения HeuristicPacker): отбрасываются решения
+  // дешевле и ветки, где даже все оставшиеся предметы, влезающие по весу, её не дают
+  int minPrice = INT_MIN;
+  // Одинаковые предметы (см. groupIdentical) кладутся только по порядку копий, и каждая следующая
+  // копия - только в позицию (поворот, строка, столбец) после предыдущей. Так из k! перестановок
+  // копий рассматривается одна; множество пар (стоимость, вес) не меняется, но раскладка
+  // для пары может отличаться номерами копий
+  bool groupIdentical = false;
+  // Распределённый перебор: ходы первого уровня (предмет, поворот, клетка) нумеруются в порядке
+  // обхода, и этот перебор берёт только ходы с номером % shards == shard
+  int shard = 0, shards = 1;
+  // Остановить перебор после стольких узлов (0 - без ограничения); см. BacktrackSolver::stopped
+  long long nodeLimit = 0;
+  // Отбор решений: при Selection != All хранятся только лучшие по (стоимость, tiebreak),
+  // а граница стоимости поднимается до худшего из них - ветки, которые не могут его превзойти,
+  // отсекаются так же, как по minPrice. При равенстве ключей лучше более лёгкое решение.
+  // В распределённом переборе отбор делается в каждой части отдельно
+  Selection select = Selection::All;
+  Tiebreak tiebreak = Tiebreak::None;
+  int topK = 1;
+};
+
+// Ход перебора (см. BacktrackSolver::reportProgress)
+struct SolveProgress {
+  long long nodes = 0;  // Рассмотрено узлов
+  bool found = false;   // Найдено ли хотя бы одно решение
+  int bestPrice = 0;    // Наибольшая стоимость среди найденных решений
+  double fraction = 0;  // Доля пройденных ходов первого уровня - оценка готовности
+};
+
+// Отпечаток параметров, от которых зависит результат перебора (nodeLimit не входит - он только прерывает перебор)
+uint64_t optionsHash(const SolverOptions &options) {
+  Fnv1a h;
+  for (long long x : {(long long)options.pruneDeadSpace, (long long)options.wasteAllowance,
+                      (long long)options.incumbentAllowance, (long long)options.maxWeight, (long long)options.minPrice,
+                      (long long)options.groupIdentical, (long long)options.shard, (long long)options.shards,
+                      (long long)options.select, (long long)options.tiebreak, (long long)options.topK})
+    h.add(x);
+  return h.value;
+}
+
+class BacktrackSolver {
+ public:
+  // Клетка предмета относительно точки привязки
+  struct Cell {
+    int row, col;
+  };
+  // Один поворот/отражение предмета
+  struct Orientation {
+    vector<Cell> cells;
+  };
+
+  explicit BacktrackSolver(const BackPack &bp, SolverOptions options = {}) : backPack(bp), options(options) {}
+
+  set<BackPack> solve(const vector<Item *> &items) {
+    prepare(items);
+    set<BackPack> solutions;
+    run(solutions);
+    return solutions;
+  }
+
+  // Периодически сохранять контрольную точку в файл fileName (не чаще, чем раз в interval).
+  // Снимок делается в потоке перебора, а записывается в фоновом потоке
+  void enableCheckpoints(const string &fileName, chrono::milliseconds interval) {
+    checkpointFile = fileName;
+    checkpointInterval = interval;
+  }
+  // Продолжить перебор с контрольной точки (файл из enableCheckpoints). Задача и параметры
+  // должны совпадать с теми, при которых точка записана.
+  // Может выбрасывать исключения: runtime_error (нет файла, другой формат или другая задача)
+  set<BackPack> resume(const vector<Item *> &items) {
+    prepare(items);
+    Checkpoint cp = readCheckpoint(checkpointFile);
+    if (cp.fingerprint != fingerprint()) throw runtime_error("Checkpoint " + checkpointFile + " belongs to another task");
+    set<BackPack> solutions;
+    for (auto &s : cp.solutions) {
+      solutions.insert(s.bp);
+      origins[{s.bp.price, s.bp.weight}] = s.origin;
+    }
+    explored = cp.explored;
+    cut = cp.cut;
+    rootMoves = cp.rootMoves;
+    allowance = cp.allowance;
+    select(solutions);  // Восстановить границу стоимости
+    if (cp.done) return solutions;
+    resumePath = std::move(cp.path);
+    run(solutions);
+    return solutions;
+  }
+  // Вызывать callback из потока перебора не чаще, чем раз в interval, и один раз в конце перебора
+  void reportProgress(function<void(const SolveProgress &)> callback, chrono::milliseconds interval) {
+    progressCallback = std::move(callback);
+    progressInterval = interval;
+  }
+  // Попросить перебор остановиться (можно из другого потока). Перебор проверяет флаг в каждом узле
+  // и возвращает решения, найденные до остановки; отменённый решатель больше не перебирает
+  void cancel() { cancelRequested.store(true, memory_order_relaxed); }
+
+  // Был ли последний перебор остановлен до завершения (nodeLimit или cancel); решения при этом неполные
+  [[nodiscard]] bool stopped() const { return stopping; }
+
+  // Количество рассмотренных состояний (узлов дерева решений) при последнем solve
+  [[nodiscard]] long long nodes() const { return explored; }
+  // Количество отсечённых веток (перевес, граница стоимости, мёртвое пространство)
+  [[nodiscard]] long long pruned() const { return cut; }
+  // Номер хода первого уровня, в ветке которого найдено решение (-1 - пустой рюкзак без ходов).
+  // По нему результаты частей распределённого перебора сливаются так же, как в одном процессе
+  [[nodiscard]] int origin(const BackPack &bp) const {
+    auto it = origins.find({bp.price, bp.weight});
+    return it == origins.end() ? -1 : it->second;
+  }
+
+ private:
+  BackPack backPack;                      // Начальное состояние рюкзака
+  SolverOptions options;
+  vector<const Item *> items;             // Предметы
+  uint64_t instance = 0;                  // Отпечаток задачи (instanceHash)
+  vector<vector<Orientation>> shapes;     // Повороты каждого предмета в порядке genAllRotations
+  vector<int> itemCells;                  // Количество клеток каждого предмета
+  vector<int> densityOrder;               // Предметы по убыванию стоимости клетки
+  vector<string> grid;                    // Текущее состояние рюкзака
+  int width = 0;                          // Длина самой длинной строки сетки
+  vector<Cell> undo;                      // Клетки, занятые положенными предметами
+  vector<char> used;                      // Положен ли предмет
+  vector<int> previousCopy;               // Предыдущая копия такого же предмета (-1 - нет) при groupIdentical
+  vector<int> position;                   // Позиция, в которую положен предмет (для порядка копий)
+  int placed = 0, weight = 0, price = 0;  // Текущее состояние поиска
+  int freeCells = 0;                      // Количество клеток '_' в сетке
+  int allowance = 0;                      // Текущий допуск потерь
+  int floorPrice = INT_MIN;               // Решения дешевле не нужны (minPrice или худшее из отобранных)
+  long long explored = 0, cut = 0;
+  int rootMoves = 0;                     // Сколько ходов первого уровня уже пронумеровано
+  map<pair<int, int>, int> origins;      // (стоимость, вес) -> ход первого уровня
+  vector<SearchMove> path;               // Ходы от корня до текущего узла
+  vector<SearchMove> resumePath;         // Путь контрольной точки, по которому ещё нужно пройти
+  bool stopping = false;                 // Перебор прерван, идёт возврат к корню
+  atomic<bool> cancelRequested{false};   // Запрошена остановка (cancel)
+  int rootTotal = 0;                     // Всего ходов первого уровня
+  // Сообщения о ходе перебора
+  function<void(const SolveProgress &)> progressCallback;
+  chrono::milliseconds progressInterval{0};
+  chrono::steady_clock::time_point nextProgress;
+  // Контрольные точки
+  string checkpointFile;
+  chrono::milliseconds checkpointInterval{0};
+  chrono::steady_clock::time_point nextCheckpoint;
+  unique_ptr<CheckpointWriter> writer;
+  // Разметка связных областей: клетка помечена, если mark == stamp (очищать массив не нужно)
+  vector<unsigned> mark;
+  unsigned stamp = 0;
+  vector<Cell> queue;  // Очередь заливки
+
+  void prepare(const vector<Item *> &source) {
+    items.assign(source.begin(), source.end());
+    instance = instanceHash(backPack, source);
+    shapes.assign(items.size(), {});
+    itemCells.assign(items.size(), 0);
+    int cells = 0;
+    for (int i = 0; i < items.size(); i++) {
+      for (auto &shape : genAllRotations(items[i]->shape)) {
+        Orientation o;
+        for (int r = 0; r < shape.size(); r++) {
+          for (int c = 0; c < shape[r].size(); c++) {
+            if (shape[r][c] == '@') o.cells.push_back({r, c});
+          }
+        }
+        shapes[i].push_back(std::move(o));
+      }
+      if (!shapes[i].empty()) itemCells[i] = shapes[i][0].cells.size();
+      cells += itemCells[i];
+    }
+    densityOrder.resize(items.size());
+    iota(densityOrder.begin(), densityOrder.end(), 0);
+    sort(densityOrder.begin(), densityOrder.end(), [this](int a, int b) {
+      return (long long)items[a]->price * max(1, itemCells[b]) > (long long)items[b]->price * max(1, itemCells[a]);
+    });
+    grid = backPack.shape;
+    width = 0;
+    freeCells = 0;
+    for (auto &row : grid) {
+      width = max(width, int(row.size()));
+      freeCells += count(row.begin(), row.end(), '_');
+    }
+    mark.assign(grid.size() * width, 0);
+    stamp = 0;
+    queue.reserve(freeCells);
+    allowance = options.incumbentAllowance ? INT_MAX : options.wasteAllowance;
+    undo.clear();
+    undo.reserve(cells);  // Больше клеток, чем у всех предметов, занято не будет
+    used.assign(items.size(), 0);
+    previousCopy.assign(items.size(), -1);
+    position.assign(items.size(), -1);
+    if (options.groupIdentical) {
+      for (auto &group : groupIdentical(source)) {
+        for (int k = 1; k < group.count(); k++) previousCopy[group.indices[k]] = group.indices[k - 1];
+      }
+    }
+    placed = 0;
+    weight = backPack.weight;
+    price = backPack.price;
+    explored = 1;
+    cut = 0;
+    rootMoves = 0;
+    origins.clear();
+    path.clear();
+    path.reserve(items.size());
+    resumePath.clear();
+    stopping = false;
+    floorPrice = options.minPrice;
+    // Ходы первого уровня нумеруются так же, как в search (копии - только первая)
+    rootTotal = 0;
+    for (int i = 0; i < items.size(); i++) {
+      if (previousCopy[i] >= 0) continue;
+      for (auto &o : shapes[i]) {
+        for (int row = 0; row < grid.size(); row++) {
+          for (int col = 0; col < grid[row].size(); col++) {
+            if (grid[row][col] != '#' && fits(o, row, col)) rootTotal++;
+          }
+        }
+      }
+    }
+    nextProgress = chrono::steady_clock::now() + progressInterval;
+  }
+
+  // Помещается ли поворот o с привязкой к клетке (row, col) - сетка не меняется
+  bool fits(const Orientation &o, int row, int col) const {
+    for (const Cell &cell : o.cells) {
+      int r = row + cell.row, c = col + cell.col;
+      if (r >= grid.size() || c >= grid[r].size() || grid[r][c] != '_') return false;
+    }
+    return true;
+  }
+  void place(const Orientation &o, int row, int col, char symbol) {
+    for (const Cell &cell : o.cells) {
+      grid[row + cell.row][col + cell.col] = symbol;
+      undo.push_back({row + cell.row, col + cell.col});
+    }
+    freeCells -= o.cells.size();
+  }
+  void unplace(const Orientation &o) {
+    for (int k = 0; k < o.cells.size(); k++) {
+      grid[undo.back().row][undo.back().col] = '_';
+      undo.pop_back();
+    }
+    freeCells += o.cells.size();
+  }
+
+  // Потерянные клетки: свободные области, в которые не влезет ни один из оставшихся предметов.
+  // Области только дробятся, а оставшиеся предметы только убывают, поэтому потери вдоль пути не уменьшаются
+  int deadSpace() {
+    int minCells = INT_MAX;
+    for (int i = 0; i < items.size(); i++) {
+      if (!used[i]) minCells = min(minCells, itemCells[i]);
+    }
+    if (freeCells < minCells) return freeCells;  // Не влезет ничего (в том числе когда предметов не осталось)
+    if (++stamp == 0) {  // Счётчик переполнился - очищаем разметку
+      fill(mark.begin(), mark.end(), 0);
+      stamp = 1;
+    }
+    int waste = 0;
+    for (int row = 0; row < grid.size(); row++) {
+      for (int col = 0; col < grid[row].size(); col++) {
+        if (grid[row][col] != '_' || mark[row * width + col] == stamp) continue;
+        // Заливка области, начиная с клетки (row, col)
+        queue.clear();
+        queue.push_back({row, col});
+        mark[row * width + col] = stamp;
+        for (int k = 0; k < queue.size(); k++) {
+          Cell cur = queue[k];
+          const Cell next[4] = {{cur.row - 1, cur.col}, {cur.row + 1, cur.col}, {cur.row, cur.col - 1}, {cur.row, cur.col + 1}};
+          for (const Cell &n : next) {
+            if (n.row < 0 || n.row >= grid.size() || n.col < 0 || n.col >= grid[n.row].size()) continue;
+            if (grid[n.row][n.col] != '_' || mark[n.row * width + n.col] == stamp) continue;
+            mark[n.row * width + n.col] = stamp;
+            queue.push_back(n);
+          }
+        }
+        if (queue.size() < minCells) waste += queue.size();
+      }
+    }
+    return waste;
+  }
+
+  // Ветка заведомо не даёт решений: перевес, не достигается граница стоимости или потери больше допуска
+  bool hopeless() {
+    if (weight > options.maxWeight) return true;
+    if (floorPrice != INT_MIN && price + priceBound() < floorPrice) return true;
+    return options.pruneDeadSpace && deadSpace() > allowance;
+  }
+
+  // Оценка сверху стоимости оставшихся предметов: дробный рюкзак по свободным клеткам -
+  // предметы, проходящие по весу, берутся по убыванию стоимости клетки, последний - частично
+  [[nodiscard]] double priceBound() const {
+    double best = 0;
+    int cells = freeCells;
+    for (int i : densityOrder) {
+      if (used[i] || items[i]->price <= 0 || items[i]->weight > options.maxWeight - weight) continue;
+      if (itemCells[i] <= cells) {
+        best += items[i]->price;
+        cells -= itemCells[i];
+      } else {
+        best += double(items[i]->price) * cells / itemCells[i];
+        break;
+      }
+    }
+    return best;
+  }
+
+  // Отпечаток задачи и параметров, влияющих на ход перебора
+  uint64_t fingerprint() const {
+    Fnv1a h;
+    h.add((long long)instance);
+    h.add((long long)optionsHash(options));
+    return h.value;
+  }
+
+  Checkpoint makeCheckpoint(const set<BackPack> &solutions, bool done) const {
+    Checkpoint cp;
+    cp.fingerprint = fingerprint();
+    cp.done = done;
+    cp.explored = explored;
+    cp.cut = cut;
+    cp.rootMoves = rootMoves;
+    cp.allowance = allowance;
+    if (!done) cp.path = path;
+    for (auto &bp : solutions) cp.solutions.push_back({bp, origin(bp)});
+    return cp;
+  }
+
+  // Перебор от корня с контрольными точками: в начале, периодически и в конце
+  void run(set<BackPack> &solutions) {
+    if (!checkpointFile.empty()) {
+      writer = make_unique<CheckpointWriter>(checkpointFile);
+      nextCheckpoint = chrono::steady_clock::now() + checkpointInterval;
+    }
+    search(solutions);
+    if (writer) {
+      if (!stopping) writer->post(makeCheckpoint(solutions, true));
+      writer.reset();  // Дожидаемся записи
+    }
+    if (progressCallback) progressCallback(progress(solutions));
+  }
+
+  [[nodiscard]] SolveProgress progress(const set<BackPack> &solutions) const {
+    SolveProgress p;
+    p.nodes = explored;
+    p.found = !solutions.empty();
+    if (p.found) p.bestPrice = solutions.rbegin()->price;
+    // Ход первого уровня, в ветке которого идёт (или прерван) перебор, ещё не пройден
+    int done = placed > 0 || stopping ? max(0, rootMoves - 1) : rootMoves;
+    p.fraction = rootTotal == 0 ? 1.0 : double(done) / rootTotal;
+    return p;
+  }
+
+  // Проверки при входе в узел: пора ли сохранить контрольную точку или сообщить о ходе перебора
+  // и не пора ли остановиться. Время проверяем не на каждом узле, чтобы не замедлять перебор
+  bool interrupted(const set<BackPack> &solutions) {
+    if ((options.nodeLimit > 0 && explored > options.nodeLimit) || cancelRequested.load(memory_order_relaxed)) {
+      stopping = true;
+      if (writer) writer->post(makeCheckpoint(solutions, false));  // Продолжить можно с этого узла
+      return true;
+    }
+    if (writer && (checkpointInterval.count() == 0 || (explored & 255) == 0) &&
+        chrono::steady_clock::now() >= nextCheckpoint) {
+      writer->post(makeCheckpoint(solutions, false));
+      nextCheckpoint = chrono::steady_clock::now() + checkpointInterval;
+    }
+    if (progressCallback && (progressInterval.count() == 0 || (explored & 255) == 0) &&
+        chrono::steady_clock::now() >= nextProgress) {
+      progressCallback(progress(solutions));
+      nextProgress = chrono::steady_clock::now() + progressInterval;
+    }
+    return false;
+  }
+
+  // Запомнить текущее состояние как решение, если такой пары (стоимость, вес) ещё не было.
+  // При отборе по заполнению (Tiebreak::MaxFill) более полная раскладка заменяет найденную раньше
+  void snapshot(set<BackPack> &solutions) {
+    if (price < floorPrice) return;
+    if (options.pruneDeadSpace) {
+      if (freeCells > allowance) return;  // Заполнение хуже допуска
+      if (options.incumbentAllowance && freeCells < allowance) {
+        allowance = freeCells;
+        for (auto it = solutions.begin(); it != solutions.end();) {
+          it = it->freeCells > allowance ? solutions.erase(it) : next(it);
+        }
+      }
+    }
+    auto found = solutions.find(BackPack({}, weight, price));
+    if (found != solutions.end()) {
+      if (options.tiebreak != Tiebreak::MaxFill || found->freeCells <= freeCells) return;
+      solutions.erase(found);
+    }
+    solutions.insert(BackPack(grid, weight, price, freeCells));
+    origins[{price, weight}] = placed == 0 ? -1 : rootMoves - 1;
+    select(solutions);
+  }
+
+  // Ключ отбора: больше - лучше
+  [[nodiscard]] pair<int, int> rankKey(const BackPack &bp) const {
+    switch (options.tiebreak) {
+      case Tiebreak::MaxFill:
+        return {bp.price, -bp.freeCells};
+      case Tiebreak::MinWeight:
+        return {bp.price, -bp.weight};
+      default:
+        return {bp.price, 0};
+    }
+  }
+
+  // Оставить только отбираемые решения и поднять границу стоимости
+  void select(set<BackPack> &solutions) {
+    if (options.select == Selection::All || solutions.empty()) return;
+    // set упорядочен по (стоимость, вес), поэтому при равном ключе более лёгкие идут раньше
+    vector<set<BackPack>::iterator> order;
+    for (auto it = solutions.begin(); it != solutions.end(); ++it) order.push_back(it);
+    stable_sort(order.begin(), order.end(), [this](auto a, auto b) { return rankKey(*a) > rankKey(*b); });
+    size_t keep = 1;
+    if (options.select == Selection::TopK) {
+      keep = max(1, options.topK);
+    } else if (options.select == Selection::Ties) {
+      while (keep < order.size() && rankKey(*order[keep]) == rankKey(*order[0])) keep++;
+    }
+    if (order.size() >= keep) {
+      // Лучшее решение с той же стоимостью возможно, только если есть второй ключ
+      int worst = order[keep - 1]->price;
+      bool strict = options.select == Selection::Best && options.tiebreak == Tiebreak::None;
+      floorPrice = max(floorPrice, strict && worst < INT_MAX ? worst + 1 : worst);
+    }
+    for (size_t i = keep; i < order.size(); i++) {
+      origins.erase({order[i]->price, order[i]->weight});
+      solutions.erase(order[i]);
+    }
+  }
+
+  void search(set<BackPack> &solutions) {
+    // При продолжении с контрольной точки на этой глубине начинаем с хода пути (он уже учтён в статистике)
+    bool resume = placed < resumePath.size();
+    SearchMove from = resume ? resumePath[placed] : SearchMove{0, 0, 0, 0};
+    if (!resume) {
+      resumePath.clear();
+      if (interrupted(solutions)) return;
+    }
+    bool hasChild = resume;
+    for (int i = from.item; i < items.size(); i++) {
+      if (used[i]) continue;
+      // Копия ложится только после предыдущей (та ложится туда же, поэтому дети узла не теряются)
+      int previous = previousCopy[i];
+      if (previous >= 0 && !used[previous]) continue;
+      for (int k = resume ? from.orientation : 0; k < shapes[i].size(); k++) {
+        const Orientation &o = shapes[i][k];
+        for (int row = resume ? from.row : 0; row < grid.size(); row++) {
+          for (int col = resume ? from.col : 0; col < grid[row].size(); col++) {
+            int pos = (k * int(grid.size()) + row) * width + col;
+            if (resume) {
+              resume = false;  // Ход пути: проверки и нумерация уже были до контрольной точки
+            } else {
+              // Позиция до предыдущей копии - та же раскладка с переставленными копиями.
+              // Узел всё равно не лист, если предмет сюда помещается
+              bool symmetric = previous >= 0 && pos <= position[previous];
+              if (symmetric && hasChild) continue;
+              if (grid[row][col] == '#' || !fits(o, row, col)) continue;
+              hasChild = true;
+              if (symmetric) continue;
+              if (placed == 0 && rootMoves++ % options.shards != options.shard) continue;  // Ход другой части
+              explored++;
+            }
+            place(o, row, col, char('1' + i));
+            path.push_back({i, k, row, col});
+            position[i] = pos;
+            used[i] = 1;
+            placed++;
+            weight += items[i]->weight;
+            price += items[i]->price;
+            if (hopeless())
+              cut++;  // Ни один лист этой ветки не подходит
+            else if (placed == items.size())
+              snapshot(solutions);
+            else
+              search(solutions);
+            price -= items[i]->price;
+            weight -= items[i]->weight;
+            placed--;
+            used[i] = 0;
+            path.pop_back();
+            unplace(o);
+            if (stopping) return;
+          }
+        }
+      }
+    }
+    if (!hasChild && (placed > 0 || options.shard == 0)) snapshot(solutions);
+  }
+};
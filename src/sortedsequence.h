@@ -1,26 +1,84 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
 #include "dynamicarray.h"
 #include "sequence.h"
 
 // Является модификацией интерфейса Sequence, описывающей отсортированные последовательности.
 // Основное отличие состоит в том, что методы Append, Prepend и InsertAt заменены одним методом Add
+// Поиск - двоичный, за O(log n). В буферизованном режиме add кладёт элемент в небольшой отсортированный буфер,
+// а буфер сливается с массивом за один проход при endBatch или когда он вырастает до ~√n элементов.
+// Чтение ищет сразу в массиве и в буфере и ничего не меняет, поэтому одновременное чтение
+// из нескольких потоков безопасно, в том числе во время пачки
 template <typename TElement>
 struct SortedSequence {  // : public Sequence<TElement>
  private:
   DynamicArray<TElement> data;  // Массив данных
+  vector<TElement> pending;     // Ещё не слитые элементы буферизованного режима, отсортированы
+  bool buffered = false;                // Включён ли буферизованный режим
+
+  // Слить в массив data отсортированный массив items за один проход с конца
+  static void mergeSorted(DynamicArray<TElement> &data, vector<TElement> &items) {
+    int n = data.getSize(), m = items.size();
+    if (m == 0) return;
+    data.resize(n + m);
+    TElement *a = data.getData();
+    int i = n - 1, j = m - 1;
+    // Элементы с равными значениями: новые встают после старых (как при add)
+    for (int k = n + m - 1; j >= 0; k--) {
+      if (i >= 0 && items[j] < a[i])
+        a[k] = std::move(a[i--]);
+      else
+        a[k] = std::move(items[j--]);
+    }
+    data.defineAll();
+    items.clear();
+  }
+  // Слить буфер с массивом
+  void flush() {
+    mergeSorted(data, pending);
+  }
+  // Сколько первых элементов последовательности лежат в массиве, если всего первых элементов count.
+  // Порядок тот же, что после слияния: при равных значениях элементы массива идут раньше элементов буфера
+  [[nodiscard]] int splitAt(int count) const {
+    const TElement *a = data.getData();
+    int n = data.getSize(), m = pending.size();
+    int lo = max(0, count - m), hi = min(count, n);
+    while (lo < hi) {
+      int i = lo + (hi - lo) / 2, j = count - i;
+      if (pending[j - 1] < a[i])
+        hi = i;
+      else
+        lo = i + 1;
+    }
+    return lo;
+  }
+  // Элемент с индексом index без проверки индекса
+  [[nodiscard]] const TElement &at(int index) const {
+    const TElement *a = data.getData();
+    int i = splitAt(index), j = index - i;
+    if (j == pending.size() || (i < data.getSize() && !(pending[j] < a[i]))) return a[i];
+    return pending[j];
+  }
+
  public:
   // Длина последовательности (количество элементов)
   [[nodiscard]] int getLength() const {
-    return data.getSize();
+    return data.getSize() + pending.size();
   }
   // Признак того, является ли последовательность пустой
   [[nodiscard]] int getIsEmpty() const {
-    return data.getSize() == 0;
+    return getLength() == 0;
   }
   // Получение элемента по индексу
   TElement get(int index) const {
-    return data[index];
+    if (index < 0 || index >= getLength())
+      throw IndexOutOfRange(string("Index ") + to_string(index) + " out of range 0.." + to_string(getLength() - 1));
+    return at(index);
   }
   // Перегруженные операторы чтобы можно было обращаться к элементу как в
   // обычном массиве
@@ -29,37 +87,80 @@ struct SortedSequence {  // : public Sequence<TElement>
   }
   // Получить первый элемент последовательности
   TElement getFirst() const {
-    return data[0];
+    return get(0);
   }
   // Получить последний элемент последовательности
   TElement getLast() const {
-    return data[data.getSize() - 1];
+    return get(getLength() - 1);
   }
-  // Получить индекс элемента последовательности.
+  // Получить индекс элемента последовательности (первого из равных).
   // Если указанного элемента в последовательности не содержится,
   // возвращается значение -1
-  int indexOf(TElement element) const {
-    for (int i = 0; i < data.getSize(); i++) {
-      if (data[i] == element) return i;
-    }
+  int indexOf(const TElement &element) const {
+    int index = lower_bound(element);
+    if (index < getLength() && at(index) == element) return index;
     return -1;
   }
+  // Индекс первого элемента, не меньшего element (getLength(), если таких нет)
+  [[nodiscard]] int lower_bound(const TElement &element) const {
+    const TElement *a = data.getData();
+    return int(std::lower_bound(a, a + data.getSize(), element) - a) +
+           int(std::lower_bound(pending.begin(), pending.end(), element) - pending.begin());
+  }
+  // Индекс первого элемента, большего element (getLength(), если таких нет)
+  [[nodiscard]] int upper_bound(const TElement &element) const {
+    const TElement *a = data.getData();
+    return int(std::upper_bound(a, a + data.getSize(), element) - a) +
+           int(std::upper_bound(pending.begin(), pending.end(), element) - pending.begin());
+  }
+  // Содержится ли элемент в последовательности
+  [[nodiscard]] bool contains(const TElement &element) const {
+    return indexOf(element) != -1;
+  }
   // Получить подпоследовательность:
   // начиная с элемента с индексом startIndex и заканчивая элементом
   // с индексом endIndex
+  // Может выбрасывать исключения: IndexOutOfRange (если диапазон выходит за границы последовательности)
   SortedSequence<TElement> getSubsequence(int startIndex, int endIndex) const {
+    if (startIndex < 0 || endIndex >= getLength() || endIndex < startIndex - 1)
+      throw IndexOutOfRange(string("Range ") + to_string(startIndex) + ".." + to_string(endIndex) + " out of range 0.." +
+                            to_string(getLength() - 1));
     SortedSequence<TElement> res;
-    for (int i = startIndex; i <= endIndex; i++) {
-      res.data.append(data[i]);
-    }
+    int from = splitAt(startIndex), to = splitAt(endIndex + 1);
+    res.data.appendRange(data, from, to - from);  // Одним блоком
+    // Элементы буфера из этого диапазона
+    vector<TElement> items(pending.begin() + (startIndex - from), pending.begin() + (endIndex + 1 - to));
+    mergeSorted(res.data, items);
     return res;
   }
   // Добавить элемент в последовательность. Элемент автоматически вставляется так,
   // что итоговая последовательность остается отсортированной
   void add(TElement element) {
-    // Ищем место куда вставить новый элемент
-    int index = 0;
-    while (index < data.getSize() && data[index] < element) index++;
-    data.insertAt(element, index);
+    if (buffered) {
+      // Вставка в буфер (после равных); большой буфер сливается с массивом
+      pending.insert(std::upper_bound(pending.begin(), pending.end(), element), std::move(element));
+      if (pending.size() > 64 + sqrt(double(data.getSize()))) flush();
+      return;
+    }
+    // Ищем место куда вставить новый элемент (после равных) двоичным поиском
+    const TElement *a = data.getData();
+    int index = int(std::upper_bound(a, a + data.getSize(), element) - a);
+    data.insertAt(std::move(element), index);
+  }
+  // Добавить сразу много элементов: пачка сортируется и сливается с последовательностью за один проход
+  template <class It>
+  void addRange(It first, It last) {
+    flush();
+    vector<TElement> items(first, last);
+    stable_sort(items.begin(), items.end());
+    mergeSorted(data, items);
+  }
+  // Буферизованный режим: add вставляет элементы в буфер, который сливается с массивом одним проходом
+  void beginBatch() {
+    buffered = true;
+  }
+  void endBatch() {
+    buffered = false;
+    flush();
   }
 };
\ No newline at end of file
@@ -2,11 +2,20 @@
 
 #include <cwchar>
 #include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "parallel.h"
 
 // == АТД (абстрактные типы данных) ==
 
 // n-арное дерево - целевой АТД, указанный в варианте задания
-// T - тип данных которые мы храним в дереве
+// T - тип данных которые мы храним в дереве.
+// Все обходы (поиск, reduce, печать, удаление) используют явный стек, поэтому глубокие деревья
+// не переполняют стек вызовов. reduceParallel и visitParallel обрабатывают поддеревья
+// верхних уровней (до глубины cutoff) параллельно в общем пуле потоков
 template <class T, int N>
 class Tree {
   // Количество детей у каждого узла - N
@@ -14,87 +23,189 @@ class Tree {
   struct Node {      // Узел дерева
     T value;         // Значение в узле
     Node *child[N];  // Дети данного узла (их N)
-    Node *parent;
+    Node *parent = nullptr;
     explicit Node(T value) : value(value) {
       for (int i = 0; i < N; i++) child[i] = nullptr;
     }
-    bool find(T v) {
-      if (v == this->value) {
-        return true;
+  };
+  Node *root = nullptr;  // Корень дерева
+  Node *tail = nullptr;  // Узел, в который попадёт следующая вставка
+
+  // Кадр явного стека обхода: узел и номер следующего ребёнка
+  struct Frame {
+    Node *node;
+    int next;
+  };
+
+  // Обход поддерева n в прямом порядке; visitor возвращает false, если обход нужно прекратить
+  template <class V>
+  static bool walk(Node *n, V &visitor) {
+    if (n == nullptr) return true;
+    std::vector<Node *> stack{n};
+    while (!stack.empty()) {
+      Node *cur = stack.back();
+      stack.pop_back();
+      if (!visitor(cur->value)) return false;
+      for (int i = N - 1; i >= 0; i--) {
+        if (cur->child[i]) stack.push_back(cur->child[i]);
       }
-      for (int i = 0; i < N; i++) {
-        if (child[i] && child[i]->find(v)) {
-          return true;
+    }
+    return true;
+  }
+
+  // Свёртка поддерева n в том же порядке, что и рекурсивное f(value, reduce(child[i])).
+  // Явный стек: значение узла копится в acc[уровень], при выходе из узла вливается в родителя
+  template <class F>
+  static T reduceSubtree(Node *n, F &f) {
+    std::vector<Frame> stack{{n, 0}};
+    std::vector<T> acc{n->value};
+    while (true) {
+      Frame &top = stack.back();
+      if (top.next < N) {
+        Node *c = top.node->child[top.next++];
+        if (c) {
+          stack.push_back({c, 0});
+          acc.push_back(c->value);
         }
+        continue;
       }
-      return false;
+      stack.pop_back();
+      if (stack.empty()) return acc.back();
+      T value = std::move(acc.back());
+      acc.pop_back();
+      acc.back() = f(std::move(acc.back()), std::move(value));
     }
-  };
-  Node *root = nullptr;  // Корень дерева
+  }
+
+  // Параллельная свёртка: до глубины cutoff дети узла сворачиваются параллельно,
+  // результаты объединяются по порядку детей, глубже - reduceSubtree
+  template <class F>
+  static T reduceParallel(Node *n, F &f, int cutoff) {
+    if (cutoff <= 0) return reduceSubtree(n, f);
+    T results[N];
+    ThreadPool::global().parallelFor(N, N, [&](int i, int, int) {
+      if (n->child[i]) results[i] = reduceParallel(n->child[i], f, cutoff - 1);
+    });
+    T value = n->value;
+    for (int i = 0; i < N; i++) {
+      if (n->child[i]) value = f(std::move(value), std::move(results[i]));
+    }
+    return value;
+  }
+
+  template <class V>
+  static void visitParallel(Node *n, V &visitor, int cutoff) {
+    if (cutoff <= 0) {
+      walk(n, visitor);
+      return;
+    }
+    visitor(n->value);
+    ThreadPool::global().parallelFor(N, N, [&](int i, int, int) {
+      if (n->child[i]) visitParallel(n->child[i], visitor, cutoff - 1);
+    });
+  }
+
+  // Глубина, до которой имеет смысл делить работу: поддеревьев хватает на все потоки с запасом
+  static int defaultCutoff() {
+    int tasks = ThreadPool::global().concurrency() * 4, depth = 0;
+    for (long long width = 1; width < tasks && N > 1; width *= N) depth++;
+    return depth;
+  }
+
  public:
   explicit Tree() = default;
-  // Вставка элемента
+  Tree(const Tree &) = delete;
+  Tree &operator=(const Tree &) = delete;
+  ~Tree() {
+    if (root == nullptr) return;
+    std::vector<Node *> stack{root};
+    while (!stack.empty()) {
+      Node *n = stack.back();
+      stack.pop_back();
+      for (int i = 0; i < N; i++) {
+        if (n->child[i]) stack.push_back(n->child[i]);
+      }
+      delete n;
+    }
+  }
+  // Вставка элемента на ближайшее пустое место: сначала заполняются дети узла,
+  // затем вставка продолжается в последнем ребёнке. Узел для вставки запоминается (tail),
+  // поэтому вставка выполняется за O(1)
   void insert(T value) {
     // Создаём новый узел дерева
     auto *n = new Node(value);
     if (root == nullptr) {  // Если дерево пустое => новый узел становится корнем
-      root = n;
-    } else {
-      root = insert(root, n);
+      root = tail = n;
+      return;
     }
-  }
-  Node *insert(Node *r, Node *newNode) {
-    // Вставляем на ближайшее пустое место
-    int idx = 0;
-    for (int i = 0; i < N; i++) {
-      if (r->child[i]) {
-        idx = i;
-      } else {
-        r->child[i] = newNode;
-        return r;
-      }
-    }
-    r->child[idx] = insert(r->child[idx], newNode);
-    return r;
+    int i = 0;
+    while (tail->child[i]) i++;
+    tail->child[i] = n;
+    n->parent = tail;
+    if (i == N - 1) tail = n;  // Дети заполнены - дальше вставляем в последнего ребёнка
   }
   // Поиск элемента по значению
   bool find(T value) {
-    if (root == nullptr) {
-      return false;
-    }
-    return root->find(value);
+    auto notEqual = [&value](const T &x) { return !(x == value); };
+    return !walk(root, notEqual);
+  }
+  // Обход узлов в прямом порядке (сначала узел, потом дети)
+  template <class V>
+  void visit(V visitor) {
+    auto all = [&visitor](const T &x) {
+      visitor(x);
+      return true;
+    };
+    walk(root, all);
+  }
+  // Параллельный обход: visitor вызывается для каждого узла ровно один раз,
+  // но из разных потоков и в произвольном порядке
+  template <class V>
+  void visitParallel(V visitor) {
+    visitParallel(visitor, defaultCutoff());
+  }
+  template <class V>
+  void visitParallel(V visitor, int cutoff) {
+    if (root == nullptr) return;
+    auto all = [&visitor](const T &x) {
+      visitor(x);
+      return true;
+    };
+    visitParallel(root, all, cutoff);
   }
   // map - применение функции к каждому элементу дерево
   // Создаётся новое дерево
   Tree<T, N> *map(T (*f)(T)) {
     auto *res = new Tree<T, N>;
-    // for (T x : *this) {
-    //   res->insert(f(x));
-    // }
+    visit([res, f](const T &x) { res->insert(f(x)); });
     return res;
   }
   // where фильтрует значения из списка l с помощью функции-фильтра h
   Tree<T, N> *where(bool (*h)(T)) {
     auto *res = new Tree<T, N>;
-    // for (T x : *this) {
-    //   if (h(x)) {
-    //     res->insert(x);
-    //   }
-    // }
+    visit([res, h](const T &x) {
+      if (h(x)) res->insert(x);
+    });
     return res;
   }
-  // reduce - применяем к каждой паре значений пока не получим одно значение
-  T reduce(T (*f)(T, T)) {
-    return reduce(root, f);
+  // reduce - применяем к каждой паре значений пока не получим одно значение.
+  // Может выбрасывать исключения: IndexOutOfRange (если дерево пустое)
+  template <class F>
+  T reduce(F f) {
+    if (root == nullptr) throw IndexOutOfRange("reduce of empty tree");
+    return reduceSubtree(root, f);
   }
-  T reduce(Node *n, T (*f)(T, T)) {
-    T value = n->value;
-    for (int i = 0; i < N; i++) {
-      if (n->child[i]) {
-        value = f(value, reduce(n->child[i], f));
-      }
-    }
-    return value;
+  // Параллельный reduce: операция f должна быть ассоциативной (порядок операндов сохраняется)
+  // и безопасной для вызова из нескольких потоков. cutoff - глубина, до которой поддеревья
+  // обрабатываются отдельными задачами
+  template <class F>
+  T reduceParallel(F f) {
+    return reduceParallel(f, defaultCutoff());
+  }
+  template <class F>
+  T reduceParallel(F f, int cutoff) {
+    if (root == nullptr) throw IndexOutOfRange("reduce of empty tree");
+    return reduceParallel(root, f, cutoff);
   }
   // Ввод элементов дерева
   // Конструктор для ввода элементов стека
@@ -112,16 +223,113 @@ class Tree {
       // print(); // Текущее состояние стека
     }
   }
+  // Печать: значение узла, затем его поддеревья, перевод строки после каждого поддерева
   void print() {
-    print(root);
+    if (root == nullptr) return;
+    std::vector<Frame> stack{{root, 0}};
+    std::wcout << root->value << " ";
+    while (!stack.empty()) {
+      Frame &top = stack.back();
+      if (top.next == N) {
+        std::wcout << std::endl;
+        stack.pop_back();
+        continue;
+      }
+      Node *c = top.node->child[top.next++];
+      if (c) {
+        std::wcout << c->value << " ";
+        stack.push_back({c, 0});
+      }
+    }
   }
-  void print(Node *n) {
-    std::wcout << n->value << " ";
-    for (int i = 0; i < N; i++) {
-      if (n->child[i]) {
-        print(n->child[i]);
+};
+
+// Полное n-арное дерево с неявной (массивной) раскладкой: узлы хранятся подряд по уровням,
+// дети узла i - это узлы N*i+1 .. N*i+N, родитель - (i-1)/N.
+// Указатели не хранятся, поэтому на элемент тратится ровно sizeof(T), вставка - добавление
+// в конец массива (амортизированно O(1)), а обход и поиск идут по непрерывной памяти
+template <class T, int N>
+class ImplicitTree {
+  static_assert(N >= 1, "ImplicitTree requires N >= 1");
+  std::vector<T> data;  // Узлы в порядке обхода по уровням
+
+ public:
+  ImplicitTree() = default;
+  // Дерево из готовых значений (они займут узлы по уровням в заданном порядке)
+  template <class It>
+  ImplicitTree(It first, It last) : data(first, last) {}
+
+  // Индекс родителя узла index (для корня - -1)
+  static int parent(int index) { return index == 0 ? -1 : (index - 1) / N; }
+  // Индекс k-го ребёнка узла index (может быть >= getSize(), тогда ребёнка нет)
+  static int child(int index, int k) { return N * index + 1 + k; }
+
+  [[nodiscard]] int getSize() const { return int(data.size()); }
+  [[nodiscard]] bool getIsEmpty() const { return data.empty(); }
+  // Значение в узле с индексом index
+  const T &get(int index) const { return data[index]; }
+  const T *getData() const { return data.data(); }
+  void reserve(int capacity) { data.reserve(capacity); }
+
+  // Вставка элемента на ближайшее свободное место последнего уровня
+  void insert(T value) { data.push_back(std::move(value)); }
+
+  // Поиск элемента по значению.
+  // Для арифметических типов сравниваем блоками без ветвлений внутри блока - цикл векторизуется
+  bool find(const T &value) const {
+    const T *a = data.data();
+    int n = getSize();
+    if constexpr (std::is_arithmetic_v<T>) {
+      const int BLOCK = 64;
+      int i = 0;
+      for (; i + BLOCK <= n; i += BLOCK) {
+        bool found = false;
+        for (int j = 0; j < BLOCK; j++) found |= a[i + j] == value;
+        if (found) return true;
       }
+      for (; i < n; i++) {
+        if (a[i] == value) return true;
+      }
+      return false;
+    } else {
+      for (int i = 0; i < n; i++) {
+        if (a[i] == value) return true;
+      }
+      return false;
+    }
+  }
+
+  // map - применение функции к каждому элементу. Форма дерева сохраняется
+  template <class F>
+  ImplicitTree<T, N> *map(F f) const {
+    auto *res = new ImplicitTree<T, N>;
+    res->data.reserve(data.size());
+    for (const T &x : data) res->data.push_back(f(x));
+    return res;
+  }
+  // where - отбор элементов функцией h. Оставшиеся элементы укладываются
+  // в новое полное дерево в прежнем порядке (по уровням)
+  template <class H>
+  ImplicitTree<T, N> *where(H h) const {
+    auto *res = new ImplicitTree<T, N>;
+    for (const T &x : data) {
+      if (h(x)) res->data.push_back(x);
     }
+    return res;
+  }
+  // reduce - свёртка элементов в порядке хранения (по уровням).
+  // Операция должна быть ассоциативной и коммутативной, чтобы результат совпадал с Tree::reduce.
+  // Может выбрасывать исключения: IndexOutOfRange (если дерево пустое)
+  template <class F>
+  T reduce(F f) const {
+    if (data.empty()) throw IndexOutOfRange("reduce of empty tree");
+    T value = data[0];
+    for (int i = 1; i < getSize(); i++) value = f(value, data[i]);
+    return value;
+  }
+
+  void print() const {
+    for (const T &x : data) std::wcout << x << " ";
     std::wcout << std::endl;
   }
 };
@@ -0,0 +1,5 @@
+# Режим --shard с несуществующим файлом задачи: сообщение об ошибке и код возврата 1, без аварийного завершения
+execute_process(COMMAND ${PROGRAM} --shard 0/2 /nonexistent.txt shard-missing-input.txt RESULT_VARIABLE result)
+if (NOT result EQUAL 1)
+    message(FATAL_ERROR "Expected exit code 1, got ${result}")
+endif ()
@@ -1,10 +1,26 @@
 #include <chrono>
 #include <complex>
 #include <cstdlib>
+#include <mutex>
+#include <thread>
+#include "asyncsolve.h"
 #include "backpack.h"
 #include "btree.h"
+#include "compacttree.h"
+#include "concurrentbtree.h"
+#include "dynamicarray.h"
+#include "flatbtree.h"
+#include "pagedbtree.h"
+#include "polyomino.h"
+#include "resultcache.h"
+#include "shard.h"
+#include "sequenceview.h"
 #include "gtest/gtest.h"
+#include "heuristic.h"
+#include "objective.h"
+#include "solver.h"
 #include "sortedsequence.h"
+#include "tree.h"
 
 TEST(BackPack, loadConfiguration) {
   // Загружаем начальные условия к задаче
@@ -30,6 +46,727 @@ TEST(BackPack, loadConfiguration) {
   //        /    |     |     |
 }
 
+TEST(BackPack, solutionIndex) {
+  Config cfg("../input.txt");
+  SolutionTree tree(cfg.backPack);
+  auto solutions = tree.solve(cfg.items);
+  ASSERT_EQ(solutions.size(), tree.index.size());
+  // Диапазон по стоимости совпадает с полным перебором решений
+  for (int lo = 0; lo <= 60; lo += 5) {
+    int hi = lo + 17;
+    auto found = tree.index.priceRange(lo, hi);
+    vector<const BackPack *> expected;
+    for (auto &b : solutions)
+      if (b.price >= lo && b.price <= hi) expected.push_back(&b);
+    ASSERT_EQ(expected.size(), found.size());
+    for (int i = 0; i < found.size(); i++) {
+      ASSERT_EQ(expected[i]->price, found[i]->price);
+      ASSERT_EQ(expected[i]->weight, found[i]->weight);
+    }
+  }
+  // Диапазон по весу отсортирован по весу и содержит все подходящие решения
+  auto byWeight = tree.index.weightRange(10, 30);
+  int count = 0;
+  for (auto &b : solutions) count += b.weight >= 10 && b.weight <= 30;
+  ASSERT_EQ(count, byWeight.size());
+  for (int i = 1; i < byWeight.size(); i++) ASSERT_LE(byWeight[i - 1]->weight, byWeight[i]->weight);
+  // Самое дорогое решение
+  auto top = tree.index.topByPrice(1);
+  ASSERT_EQ(1, top.size());
+  ASSERT_EQ(solutions.rbegin()->price, top[0]->price);
+  ASSERT_TRUE(tree.index.findPrice(-1).empty());
+}
+
+TEST(BackPack, compactSolutionTree) {
+  Config cfg("../input.txt");
+  SolutionTree tree(cfg.backPack);
+  auto expected = tree.solve(cfg.items);
+  CompactSolutionTree compact(cfg.backPack);
+  auto solutions = compact.solve(cfg.items);
+  ASSERT_EQ(expected.size(), solutions.size());
+  for (auto a = expected.begin(), b = solutions.begin(); a != expected.end(); ++a, ++b) {
+    ASSERT_EQ(a->price, b->price);
+    ASSERT_EQ(a->weight, b->weight);
+    ASSERT_EQ(a->shape, b->shape);
+    ASSERT_EQ(a->freeCells, b->freeCells);
+  }
+  ASSERT_EQ(tree.index.size(), compact.index.size());
+  // Узлы с заданной стоимостью: те же изображения в том же порядке
+  for (int price = 0; price <= 60; price += 5) {
+    auto a = tree.search(price), b = compact.search(price);
+    ASSERT_EQ(a.size(), b.size());
+    for (int i = 0; i < a.size(); i++) {
+      ASSERT_EQ(a[i].bp.shape, b[i].bp.shape);
+      ASSERT_EQ(a[i].bp.weight, b[i].bp.weight);
+      ASSERT_EQ(a[i].leaf, b[i].leaf);
+    }
+  }
+  ASSERT_EQ(cfg.backPack.shape, compact.node(0).shape);
+  ASSERT_EQ(32, CompactSolutionTree::nodeBytes);
+  // Узлы лежат в блоках арены
+  ASSERT_GT(compact.size(), 1);
+  ASSERT_GE(compact.memoryBytes(), compact.size() * CompactSolutionTree::nodeBytes);
+}
+
+TEST(BackPack, backtrackSolver) {
+  Config cfg("../input.txt");
+  SolutionTree tree(cfg.backPack);
+  auto expected = tree.solve(cfg.items);
+  BacktrackSolver solver(cfg.backPack);
+  auto solutions = solver.solve(cfg.items);
+  // Те же решения и те же раскладки для каждой пары (стоимость, вес)
+  ASSERT_EQ(expected.size(), solutions.size());
+  for (auto a = expected.begin(), b = solutions.begin(); a != expected.end(); ++a, ++b) {
+    ASSERT_EQ(a->price, b->price);
+    ASSERT_EQ(a->weight, b->weight);
+    ASSERT_EQ(a->shape, b->shape);
+  }
+  ASSERT_GT(solver.nodes(), solutions.size());
+}
+
+TEST(BackPack, deadSpacePruning) {
+  Config cfg("../input.txt");
+  auto all = BacktrackSolver(cfg.backPack).solve(cfg.items);
+  auto freeCells = [](const BackPack &b) {
+    int n = 0;
+    for (auto &row : b.shape) n += count(row.begin(), row.end(), '_');
+    return n;
+  };
+  // Вариант c: остаются ровно листья полного перебора с ΔV не больше допуска, а перебор короче
+  for (int allowance : {0, 1, 3, 13}) {
+    SolverOptions options;
+    options.pruneDeadSpace = true;
+    options.wasteAllowance = allowance;
+    BacktrackSolver solver(cfg.backPack, options);
+    auto pruned = solver.solve(cfg.items);
+    vector<pair<int, int>> expected, found;
+    for (auto &b : all)
+      if (freeCells(b) <= allowance) expected.emplace_back(b.price, b.weight);
+    for (auto &b : pruned) {
+      ASSERT_LE(freeCells(b), allowance);
+      found.emplace_back(b.price, b.weight);
+    }
+    ASSERT_EQ(expected, found) << allowance;
+    if (allowance < 13) {
+      ASSERT_GT(solver.pruned(), 0);
+    }
+  }
+  // Вариант d: остаются только решения с наименьшим числом свободных клеток при весе не больше maxWeight
+  SolverOptions options;
+  options.pruneDeadSpace = true;
+  options.incumbentAllowance = true;
+  options.maxWeight = cfg.maxWeight;
+  auto best = BacktrackSolver(cfg.backPack, options).solve(cfg.items);
+  int minFree = INT_MAX;
+  for (auto &b : all)
+    if (b.weight <= cfg.maxWeight) minFree = min(minFree, freeCells(b));
+  ASSERT_FALSE(best.empty());
+  for (auto &b : best) {
+    ASSERT_EQ(minFree, freeCells(b));
+    ASSERT_LE(b.weight, cfg.maxWeight);
+  }
+}
+
+TEST(BackPack, identicalItems) {
+  Config cfg("../input.txt");
+  // Каталог с повторами: три квадрата 2x2 и две палки (вторая повёрнута - это та же группа)
+  Item square(10, 15), bar(5, 10), turnedBar(5, 10);
+  square.shape = cfg.items[2]->shape;
+  bar.shape = cfg.items[0]->shape;
+  turnedBar.shape = {"@@@@"};
+  vector<Item *> items = {&square, &bar, &square, cfg.items[1], &turnedBar, &square};
+  auto groups = groupIdentical(items);
+  ASSERT_EQ(3, groups.size());
+  ASSERT_EQ((vector<int>{0, 2, 5}), groups[0].indices);
+  ASSERT_EQ((vector<int>{1, 4}), groups[1].indices);
+  ASSERT_EQ(1, groups[2].count());
+  // Ответ не меняется, а перебор сокращается
+  BacktrackSolver full(cfg.backPack);
+  auto expected = full.solve(items);
+  SolverOptions options;
+  options.groupIdentical = true;
+  BacktrackSolver grouped(cfg.backPack, options);
+  auto solutions = grouped.solve(items);
+  ASSERT_EQ(expected.size(), solutions.size());
+  for (auto a = expected.begin(), b = solutions.begin(); a != expected.end(); ++a, ++b) {
+    ASSERT_EQ(a->price, b->price);
+    ASSERT_EQ(a->weight, b->weight);
+  }
+  ASSERT_LT(grouped.nodes() * 4, full.nodes());
+}
+
+TEST(BackPack, heuristicWarmStart) {
+  Config cfg("../input.txt");
+  auto all = BacktrackSolver(cfg.backPack).solve(cfg.items);
+  int bestPrice = INT_MIN;
+  for (auto &b : all)
+    if (b.weight <= cfg.maxWeight) bestPrice = max(bestPrice, b.price);
+  HeuristicOptions heuristicOptions;
+  heuristicOptions.maxWeight = cfg.maxWeight;
+  HeuristicPacker packer(cfg.backPack, heuristicOptions);
+  BackPack greedy = packer.greedy(cfg.items);
+  BackPack approx = packer.solve(cfg.items);
+  ASSERT_TRUE(packer.found());
+  ASSERT_LE(approx.weight, cfg.maxWeight);
+  // Отжиг начинается с жадного решения и не может его ухудшить
+  if (greedy.weight <= cfg.maxWeight) {
+    ASSERT_GE(approx.price, greedy.price);
+  }
+  // Эвристика выдаёт лист дерева решений, поэтому он есть среди решений полного перебора
+  ASSERT_TRUE(all.count(approx));
+  ASSERT_LE(approx.price, bestPrice);
+  // Повторный запуск с тем же зерном даёт то же решение
+  ASSERT_EQ(approx.shape, HeuristicPacker(cfg.backPack, heuristicOptions).solve(cfg.items).shape);
+  // Стоимость эвристики как нижняя граница для точного перебора: ответ тот же, перебор короче
+  SolverOptions options;
+  options.maxWeight = cfg.maxWeight;
+  options.minPrice = approx.price;
+  BacktrackSolver solver(cfg.backPack, options);
+  auto bounded = solver.solve(cfg.items);
+  ASSERT_FALSE(bounded.empty());
+  ASSERT_EQ(bestPrice, bounded.rbegin()->price);
+  for (auto &b : bounded) ASSERT_GE(b.price, approx.price);
+}
+
+TEST(BackPack, shardedSolve) {
+  Config cfg("../input.txt");
+  auto expected = BacktrackSolver(cfg.backPack).solve(cfg.items);
+  ASSERT_EQ(1, ShardSpec::parse("1/3").index);
+  ASSERT_THROW(ShardSpec::parse("3/3"), runtime_error);
+  ASSERT_THROW(ShardSpec::parse("1-3"), runtime_error);
+  // Каждая часть пишет свой файл, merge собирает тот же ответ, что и один процесс
+  vector<ShardFile> shards;
+  for (int k = 0; k < 3; k++) {
+    string fileName = "shard-test-" + to_string(k) + ".txt";
+    writeShard(fileName, solveShard(cfg.backPack, cfg.items, ShardSpec{k, 3}));
+    shards.push_back(readShard(fileName));
+    remove(fileName.c_str());
+  }
+  auto merged = mergeShards(shards);
+  ASSERT_EQ(expected.size(), merged.size());
+  for (auto a = expected.begin(), b = merged.begin(); a != expected.end(); ++a, ++b) {
+    ASSERT_EQ(a->price, b->price);
+    ASSERT_EQ(a->weight, b->weight);
+    ASSERT_EQ(a->shape, b->shape);
+  }
+  // Не хватает части
+  shards.pop_back();
+  ASSERT_THROW(mergeShards(shards), runtime_error);
+  ASSERT_THROW(readShard("no-such-shard.txt"), runtime_error);
+  // Часть другой задачи или с другими параметрами перебора
+  vector<Item *> fewer(cfg.items.begin(), cfg.items.end() - 1);
+  shards.push_back(solveShard(cfg.backPack, fewer, ShardSpec{2, 3}));
+  ASSERT_THROW(mergeShards(shards), runtime_error);
+  SolverOptions heavy;
+  heavy.maxWeight = 10;
+  shards.back() = solveShard(cfg.backPack, cfg.items, ShardSpec{2, 3}, heavy);
+  ASSERT_THROW(mergeShards(shards), runtime_error);
+  shards.back() = solveShard(cfg.backPack, cfg.items, ShardSpec{2, 3});
+  ASSERT_EQ(merged.size(), mergeShards(shards).size());
+  // Испорченный номер части
+  for (string spec : {"3 3", "-1 3", "0 0"}) {
+    ofstream("shard-test-bad.txt") << SHARD_MAGIC << " " << SHARD_VERSION << " 1 2\n" << spec << " 0\n";
+    ASSERT_THROW(readShard("shard-test-bad.txt"), runtime_error);
+  }
+  remove("shard-test-bad.txt");
+}
+
+TEST(BackPack, checkpointResume) {
+  Config cfg("../input.txt");
+  BacktrackSolver full(cfg.backPack);
+  auto expected = full.solve(cfg.items);
+  const string fileName = "checkpoint-test.txt";
+  for (long long limit : {1LL, 10LL, full.nodes() / 2, full.nodes() - 1}) {
+    // Первый процесс «убивают» после limit узлов - остаётся контрольная точка
+    SolverOptions options;
+    options.nodeLimit = limit;
+    BacktrackSolver killed(cfg.backPack, options);
+    killed.enableCheckpoints(fileName, chrono::milliseconds(0));
+    killed.solve(cfg.items);
+    ASSERT_TRUE(killed.stopped());
+    // Второй продолжает с неё и получает тот же результат за то же число узлов
+    BacktrackSolver resumed(cfg.backPack);
+    resumed.enableCheckpoints(fileName, chrono::milliseconds(1000));
+    auto solutions = resumed.resume(cfg.items);
+    ASSERT_FALSE(resumed.stopped());
+    ASSERT_EQ(full.nodes(), resumed.nodes()) << limit;
+    ASSERT_EQ(expected.size(), solutions.size()) << limit;
+    for (auto a = expected.begin(), b = solutions.begin(); a != expected.end(); ++a, ++b) {
+      ASSERT_EQ(a->price, b->price);
+      ASSERT_EQ(a->weight, b->weight);
+      ASSERT_EQ(a->shape, b->shape);
+    }
+    // Завершённый перебор записан как готовый: продолжение сразу возвращает ответ
+    ASSERT_TRUE(readCheckpoint(fileName).done);
+    BacktrackSolver again(cfg.backPack);
+    again.enableCheckpoints(fileName, chrono::milliseconds(1000));
+    ASSERT_EQ(expected.size(), again.resume(cfg.items).size());
+  }
+  // Контрольная точка другой задачи не подходит
+  SolverOptions other;
+  other.maxWeight = 10;
+  BacktrackSolver wrong(cfg.backPack, other);
+  wrong.enableCheckpoints(fileName, chrono::milliseconds(1000));
+  ASSERT_THROW(wrong.resume(cfg.items), runtime_error);
+  remove(fileName.c_str());
+}
+
+TEST(BackPack, resultCache) {
+  Config cfg("../input.txt");
+  const string dir = "result-cache-test";
+  filesystem::remove_all(dir);
+  ResultCache cache(dir);
+  auto solutions = BacktrackSolver(cfg.backPack).solve(cfg.items);
+  vector<BackPack> result(solutions.begin(), solutions.end()), loaded;
+  uint64_t key = ResultCache::key(cfg.backPack, cfg.items, "all", optionsHash(SolverOptions()));
+  ASSERT_FALSE(cache.load(key, loaded));
+  cache.store(key, result);
+  ASSERT_TRUE(cache.load(key, loaded));
+  ASSERT_EQ(result.size(), loaded.size());
+  for (int i = 0; i < result.size(); i++) {
+    ASSERT_EQ(result[i].price, loaded[i].price);
+    ASSERT_EQ(result[i].shape, loaded[i].shape);
+  }
+  // Другая цель, другие параметры или другая задача - другой ключ
+  SolverOptions options;
+  options.maxWeight = cfg.maxWeight;
+  ASSERT_NE(key, ResultCache::key(cfg.backPack, cfg.items, "best", optionsHash(SolverOptions())));
+  ASSERT_NE(key, ResultCache::key(cfg.backPack, cfg.items, "all", optionsHash(options)));
+  Item extra(1, 1);
+  extra.shape = {"@"};
+  vector<Item *> more = cfg.items;
+  more.push_back(&extra);
+  ASSERT_NE(key, ResultCache::key(cfg.backPack, more, "all", optionsHash(SolverOptions())));
+  // Файл другой версии формата не читается
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.l3c", (unsigned long long)key);
+  ofstream(filesystem::path(dir) / name) << "L3CACHE 0 " << key << " 0\n";
+  ASSERT_FALSE(cache.load(key, loaded));
+  // Вытеснение давно не использованных записей
+  cache.clear();
+  for (uint64_t k : {1, 2, 3}) cache.store(k, result);
+  uintmax_t entrySize = 0;
+  for (auto &entry : filesystem::directory_iterator(dir)) entrySize = max(entrySize, entry.file_size());
+  auto now = filesystem::file_time_type::clock::now();
+  for (int k = 1; k <= 3; k++) {
+    snprintf(name, sizeof(name), "%016llx.l3c", (unsigned long long)k);
+    filesystem::last_write_time(filesystem::path(dir) / name, now - chrono::hours(4 - k));
+  }
+  ASSERT_TRUE(cache.load(1, loaded));  // Запись 1 использована последней
+  ResultCache small(dir, entrySize * 5 / 2);
+  small.store(4, result);
+  ASSERT_TRUE(small.load(1, loaded));
+  ASSERT_FALSE(small.load(2, loaded));
+  ASSERT_FALSE(small.load(3, loaded));
+  ASSERT_TRUE(small.load(4, loaded));
+  filesystem::remove_all(dir);
+}
+
+TEST(BackPack, objectives) {
+  Config cfg("../input.txt");
+  auto all = BacktrackSolver(cfg.backPack).solve(cfg.items);
+  int W = cfg.maxWeight;
+  // Ожидаемые ответы - отбор из всех решений
+  int maxPrice = INT_MIN, minFree = INT_MAX;
+  for (auto &bp : all) {
+    if (bp.weight <= W) maxPrice = max(maxPrice, bp.price);
+  }
+  vector<BackPack> ties, fullest, top;
+  for (auto &bp : all) {
+    if (bp.weight <= W && bp.price == maxPrice) ties.push_back(bp);
+  }
+  for (auto &bp : ties) minFree = min(minFree, bp.freeCells);
+  for (auto &bp : ties) {
+    if (bp.freeCells == minFree) fullest.push_back(bp);
+  }
+  for (auto &bp : all) {
+    if (bp.weight <= W) top.push_back(bp);
+  }
+  stable_sort(top.begin(), top.end(), [](auto &a, auto &b) { return a.price > b.price; });
+  top.resize(min<size_t>(3, top.size()));
+  sort(top.begin(), top.end());
+  auto same = [](const vector<BackPack> &a, const vector<BackPack> &b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < a.size(); i++) {
+      if (a[i].price != b[i].price || a[i].weight != b[i].weight || a[i].shape != b[i].shape) return false;
+    }
+    return true;
+  };
+
+  Objective c;
+  c.variant = Variant::C;
+  c.select = Selection::Ties;
+  c.maxWeight = W;
+  ASSERT_TRUE(same(ties, solveObjective(cfg.backPack, cfg.items, c)));
+  Objective d = c;
+  d.variant = Variant::D;
+  ASSERT_TRUE(same(fullest, solveObjective(cfg.backPack, cfg.items, d)));
+  // d: из раскладок с равными стоимостью и весом остаётся самая полная, даже если найдена позже
+  BackPack row({"___"}, 0, 0);
+  Item pair(2, 7), triple(2, 7);
+  pair.shape = {"@@"};
+  triple.shape = {"@@@"};
+  vector<Item *> either = {&pair, &triple};
+  auto first = BacktrackSolver(row).solve(either);
+  ASSERT_EQ(1, first.size());
+  ASSERT_EQ(1, first.begin()->freeCells);
+  auto fuller = solveObjective(row, either, d);
+  ASSERT_EQ(1, fuller.size());
+  ASSERT_EQ(0, fuller[0].freeCells);
+  ASSERT_EQ(vector<string>{"222"}, fuller[0].shape);
+  Objective e;
+  e.variant = Variant::E;
+  // e: самое лёгкое из самых дорогих
+  auto best = solveObjective(cfg.backPack, cfg.items, e);
+  ASSERT_EQ(1, best.size());
+  for (auto &bp : all) {
+    ASSERT_TRUE(bp.price < best[0].price || (bp.price == best[0].price && bp.weight >= best[0].weight));
+  }
+  Objective k = c;
+  k.select = Selection::TopK;
+  k.k = 3;
+  auto found = solveObjective(cfg.backPack, cfg.items, k);
+  ASSERT_EQ(top.size(), found.size());
+  for (int i = 0; i < top.size(); i++) ASSERT_EQ(top[i].price, found[i].price);
+  // Начальная граница от эвристики - только там, где более дешёвые решения не отбираются
+  HeuristicOptions heuristic;
+  heuristic.maxWeight = W;
+  BackPack approx = HeuristicPacker(cfg.backPack, heuristic).solve(cfg.items);
+  ASSERT_EQ(approx.price, exactOptions(cfg.backPack, cfg.items, c).minPrice);
+  ASSERT_EQ(approx.price, exactOptions(cfg.backPack, cfg.items, d).minPrice);
+  ASSERT_EQ(INT_MIN, exactOptions(cfg.backPack, cfg.items, k).minPrice);
+  Objective waste = c;
+  waste.epsilon = 2;
+  ASSERT_EQ(INT_MIN, exactOptions(cfg.backPack, cfg.items, waste).minPrice);
+  auto warm = BacktrackSolver(cfg.backPack, exactOptions(cfg.backPack, cfg.items, c)).solve(cfg.items);
+  ASSERT_TRUE(same(ties, vector<BackPack>(warm.begin(), warm.end())));
+
+  // Найденное лучшее решение поднимает границу стоимости, и целевой поиск рассматривает меньше узлов
+  BackPack open({"___", "___"}, 0, 0);
+  Item square(5, 100), one(1, 1), two(1, 2), three(1, 3);
+  square.shape = {"@@", "@@"};
+  one.shape = two.shape = three.shape = {"@"};
+  vector<Item *> small = {&square, &one, &two, &three};
+  Objective bestC;
+  bestC.maxWeight = 8;
+  BacktrackSolver full(open), targeted(open, solverOptions(bestC));
+  auto everything = full.solve(small);
+  auto target = targeted.solve(small);
+  ASSERT_EQ(1, target.size());
+  ASSERT_EQ(everything.rbegin()->price, target.begin()->price);
+  ASSERT_LT(targeted.nodes() * 10, full.nodes());
+
+  // a и b: сравнение с перебором всех подмножеств предметов
+  int volume = cfg.backPack.freeCells, n = cfg.items.size();
+  vector<int> cells(n, 0);
+  for (int i = 0; i < n; i++) {
+    for (auto &row : cfg.items[i]->shape) cells[i] += count(row.begin(), row.end(), '@');
+  }
+  int bestA = 0, bestB = 0;
+  for (int mask = 0; mask < (1 << n); mask++) {
+    int v = 0, w = 0, p = 0;
+    for (int i = 0; i < n; i++) {
+      if (mask >> i & 1) v += cells[i], w += cfg.items[i]->weight, p += cfg.items[i]->price;
+    }
+    if (v <= volume) bestA = max(bestA, p);
+    if (v <= volume && w <= W) bestB = max(bestB, p);
+  }
+  Objective a;
+  a.variant = Variant::A;
+  auto ra = solveObjective(cfg.backPack, cfg.items, a);
+  ASSERT_EQ(bestA, ra[0].price);
+  Objective b = a;
+  b.variant = Variant::B;
+  b.maxWeight = W;
+  auto rb = solveObjective(cfg.backPack, cfg.items, b);
+  ASSERT_EQ(bestB, rb[0].price);
+  ASSERT_LE(rb[0].weight, W);
+  int used = 0;
+  for (auto &row : rb[0].shape) used += count_if(row.begin(), row.end(), [](char ch) { return isdigit(ch); });
+  ASSERT_EQ(volume - rb[0].freeCells, used);
+}
+
+TEST(BackPack, asyncSolve) {
+  Config cfg("../input.txt");
+  auto expected = BacktrackSolver(cfg.backPack).solve(cfg.items);
+  // Перебор до конца: те же решения, в конце пройдены все ходы первого уровня
+  vector<SolveProgress> reports;
+  AsyncSolve full(cfg.backPack, cfg.items, {}, [&reports](const SolveProgress &p) { reports.push_back(p); },
+                  chrono::milliseconds(0));
+  auto solutions = full.get();
+  ASSERT_TRUE(full.poll());
+  ASSERT_FALSE(full.stopped());
+  ASSERT_EQ(expected.size(), solutions.size());
+  ASSERT_FALSE(reports.empty());
+  for (int i = 1; i < reports.size(); i++) {
+    ASSERT_LE(reports[i - 1].nodes, reports[i].nodes);
+    ASSERT_LE(reports[i - 1].fraction, reports[i].fraction);
+  }
+  ASSERT_DOUBLE_EQ(1.0, full.progress().fraction);
+  ASSERT_EQ(expected.rbegin()->price, full.progress().bestPrice);
+
+  // Отмена долгого перебора: частичный результат - часть полного
+  BackPack open({"____", "____", "____"}, 0, 0);
+  vector<Item> store;
+  store.reserve(6);
+  store.emplace_back(5, 100).shape = {"@@", "@@"};
+  for (int i = 0; i < 5; i++) store.emplace_back(1, 1 + i).shape = {"@"};
+  vector<Item *> items;
+  for (auto &item : store) items.push_back(&item);
+  AsyncSolve running(open, items, {}, {}, chrono::milliseconds(0));
+  while (running.progress().nodes < 1000) this_thread::yield();
+  running.cancel();
+  auto partial = running.get();
+  ASSERT_TRUE(running.stopped());
+  ASSERT_FALSE(partial.empty());
+  SolveProgress last = running.progress();
+  ASSERT_LT(last.fraction, 1.0);
+  ASSERT_EQ(partial.rbegin()->price, last.bestPrice);
+  // Отмена до окончания при разрушении не ждёт полного перебора
+  { AsyncSolve abandoned(open, items); }
+}
+
+TEST(DynamicArray, growth_and_strings) {
+  DynamicArray<string> a;
+  int reallocations = 0, lastCapacity = a.getCapacity();
+  for (int i = 0; i < 1000; i++) {
+    a.append(to_string(i));
+    if (a.getCapacity() != lastCapacity) {
+      reallocations++;
+      lastCapacity = a.getCapacity();
+    }
+  }
+  ASSERT_EQ(1000, a.getSize());
+  ASSERT_LT(reallocations, 20);  // Геометрический рост, а не перевыделение на каждом append
+  a.prepend("first");
+  a.insertAt("middle", 500);
+  a.insertAt("last", a.getSize());
+  ASSERT_EQ("first", a.get(0));
+  ASSERT_EQ("0", a.get(1));
+  ASSERT_EQ("middle", a.get(500));
+  ASSERT_EQ("499", a.get(501));
+  ASSERT_EQ("last", a.get(a.getSize() - 1));
+  a.removeAt(500);
+  ASSERT_EQ("499", a.get(500));
+  ASSERT_THROW(a.insertAt("x", a.getSize() + 1), IndexOutOfRange);
+  // Копия не зависит от оригинала
+  DynamicArray<string> b(a);
+  b.set(0, "changed");
+  ASSERT_EQ("first", a.get(0));
+  b = a;
+  ASSERT_EQ("first", b.get(0));
+  // Перемещение забирает память
+  DynamicArray<string> c(std::move(b));
+  ASSERT_EQ(0, b.getSize());
+  ASSERT_EQ(a.getSize(), c.getSize());
+  c.shrink_to_fit();
+  ASSERT_EQ(c.getSize(), c.getCapacity());
+  c.resize(2);
+  ASSERT_EQ("0", c.get(1));
+  c.resize(3);
+  ASSERT_THROW(c.get(2), IndexOutOfRange);  // Новый элемент не задан
+  c.reserve(2000);
+  ASSERT_EQ(2000, c.getCapacity());
+  ASSERT_EQ(3, c.getSize());
+}
+
+TEST(DynamicArray, defined_bits) {
+  // Чередуем заданные и незаданные элементы на длине больше одного слова битовой маски
+  DynamicArray<int> a(150);
+  vector<bool> expected(150, false);
+  for (int i = 0; i < 150; i += 3) {
+    a.set(i, i);
+    expected[i] = true;
+  }
+  auto check = [&]() {
+    ASSERT_EQ(expected.size(), a.getSize());
+    for (int i = 0; i < a.getSize(); i++) {
+      if (expected[i]) {
+        ASSERT_NO_THROW(a.get(i)) << i;
+      } else {
+        ASSERT_THROW(a.get(i), IndexOutOfRange) << i;
+      }
+    }
+  };
+  check();
+  for (int index : {0, 63, 64, 100, 149}) {
+    a.insertAt(-1, index);
+    expected.insert(expected.begin() + index, true);
+    check();
+  }
+  for (int index : {150, 127, 64, 63, 1, 0}) {
+    a.removeAt(index);
+    expected.erase(expected.begin() + index);
+    check();
+  }
+  DynamicArray<int> b(a);
+  a.prepend(7);
+  expected.insert(expected.begin(), true);
+  check();
+  ASSERT_EQ(a.getSize() - 1, b.getSize());
+}
+
+TEST(ArraySequence, dense) {
+  DenseArraySequence<int> s(5);
+  ASSERT_EQ(0, s.get(3));  // Элементы плотного массива всегда заданы
+  for (int i = 0; i < 5; i++) s[i] = i + 1;
+  s.append(6);
+  ASSERT_EQ(21, s.reduce([](int a, int b) { return a + b; }));
+  Sequence<int> *doubled = s.map([](int x) { return x * 2; });
+  ASSERT_EQ(12, doubled->getLast());
+  delete doubled;
+  ArraySequence<int> sparse(5);
+  ASSERT_THROW(sparse.get(3), IndexOutOfRange);
+}
+
+TEST(DynamicArray, small_buffer) {
+  DynamicArray<string, DefinedBits, 4> a;
+  auto isInline = [&](const DynamicArray<string, DefinedBits, 4> &x) {
+    auto *p = reinterpret_cast<const char *>(x.getData());
+    return p >= reinterpret_cast<const char *>(&x) && p < reinterpret_cast<const char *>(&x) + sizeof(x);
+  };
+  ASSERT_EQ(4, a.getCapacity());
+  for (int i = 0; i < 4; i++) a.append(to_string(i));
+  ASSERT_TRUE(isInline(a));
+  a.append("4");  // Не помещается - переезд в динамическую память
+  ASSERT_FALSE(isInline(a));
+  ASSERT_EQ("4", a.get(4));
+  a.removeAt(4);
+  a.shrink_to_fit();  // Возвращаемся во встроенный буфер
+  ASSERT_TRUE(isInline(a));
+  ASSERT_EQ("3", a.get(3));
+  // Перемещение встроенного массива переносит элементы
+  DynamicArray<string, DefinedBits, 4> b(std::move(a));
+  ASSERT_TRUE(isInline(b));
+  ASSERT_EQ(4, b.getSize());
+  ASSERT_EQ(0, a.getSize());
+  a = b;
+  ASSERT_EQ("2", a.get(2));
+}
+
+TEST(ArraySequence, arena) {
+  ThreadArena &arena = ThreadArena::local();
+  size_t before;
+  {
+    ArenaScope scope;
+    SmallArraySequence<int> s;
+    for (int i = 0; i < 10; i++) s.append(i);
+    before = arena.systemAllocations();
+    // Короткие промежуточные последовательности не обращаются к системному аллокатору
+    for (int k = 0; k < 1000; k++) {
+      Sequence<int> *sub = s.getSubsequence(2, 8);
+      ASSERT_EQ(8, sub->getLast());
+      delete sub;
+    }
+    // Длинная последовательность берёт память из арены
+    SmallArraySequence<int> big;
+    for (int i = 0; i < 1000; i++) big.append(i);
+    ASSERT_EQ(999, big.getLast());
+    ASSERT_EQ(499500, big.reduce([](int a, int b) { return a + b; }));
+  }
+  ASSERT_LE(arena.systemAllocations(), before + 1);
+}
+
+TEST(SequenceView, fused_pipeline) {
+  ArraySequence<int> s;
+  for (int i = 1; i <= 100; i++) s.append(i);
+  int offset = 3;  // Лямбды могут захватывать переменные
+  auto squares = view(s).map([offset](int x) { return x * x + offset; }).where([](int x) { return x % 2 == 0; });
+  // Сравниваем с жадной цепочкой map -> where -> reduce
+  Sequence<int> *mapped = s.map([](int x) { return x * x + 3; });
+  Sequence<int> *filtered = mapped->where([](int x) { return x % 2 == 0; });
+  ASSERT_EQ(filtered->reduce([](int a, int b) { return a + b; }), squares.reduce([](int a, int b) { return a + b; }));
+  ASSERT_EQ(filtered->getLength(), squares.count());
+  Sequence<int> *materialized = squares.toSequence();
+  ASSERT_EQ(filtered->getLength(), materialized->getLength());
+  for (int i = 0; i < materialized->getLength(); i++) ASSERT_EQ(filtered->get(i), materialized->get(i));
+  delete mapped;
+  delete filtered;
+  delete materialized;
+  // Смена типа на этапе map и свёртка с начальным значением
+  auto total = view(s).map([](int x) { return x / 2.0; }).reduce([](double a, double b) { return a + b; }, 0.0);
+  ASSERT_DOUBLE_EQ(2525.0, total);
+  ASSERT_THROW(view(s).where([](int x) { return x > 1000; }).reduce([](int a, int b) { return a + b; }),
+               IndexOutOfRange);
+}
+
+TEST(ArraySequence, parallel) {
+  const int N = 100000;
+  ArraySequence<long long> s;
+  for (int i = 0; i < N; i++) s.append(i);
+  // Порог 1 - параллельный путь даже для коротких последовательностей
+  for (int threshold : {1, PARALLEL_THRESHOLD}) {
+    Sequence<long long> *mapped = s.mapParallel([](long long x) { return x * 3; }, threshold);
+    Sequence<long long> *filtered = s.whereParallel([](long long x) { return x % 7 == 0; }, threshold);
+    ASSERT_EQ(N, mapped->getLength());
+    for (int i = 0; i < N; i += 997) ASSERT_EQ(3LL * i, mapped->get(i));
+    ASSERT_EQ((N + 6) / 7, filtered->getLength());
+    for (int i = 0; i < filtered->getLength(); i++) ASSERT_EQ(7LL * i, filtered->get(i));  // Порядок сохранён
+    ASSERT_EQ(1LL * N * (N - 1) / 2, s.reduceParallel([](long long a, long long b) { return a + b; }, threshold));
+    delete mapped;
+    delete filtered;
+  }
+  // Ассоциативная, но не коммутативная операция: порядок операндов сохраняется
+  ArraySequence<wstring> words;
+  for (int i = 0; i < 2000; i++) words.append(to_wstring(i % 10));
+  wstring expected;
+  for (int i = 0; i < 2000; i++) expected += to_wstring(i % 10);
+  ASSERT_EQ(expected, words.reduceParallel([](const wstring &a, const wstring &b) { return a + b; }, 1));
+  ArraySequence<int> empty;
+  ASSERT_THROW(empty.reduceParallel([](int a, int b) { return a + b; }), IndexOutOfRange);
+}
+
+TEST(ArraySequence, iterators_and_slices) {
+  ArraySequence<int> s;
+  for (int i = 10; i > 0; i--) s.append(i);
+  sort(s.begin(), s.end());  // Непрерывные итераторы работают с алгоритмами STL
+  int expected = 1;
+  for (int x : s) ASSERT_EQ(expected++, x);
+  // Участок без копирования
+  ArraySlice<int> part = s.slice(2, 5);
+  ASSERT_EQ(4, part.size());
+  ASSERT_EQ(3, part[0]);
+  ASSERT_EQ(s.begin() + 2, part.begin());
+  ASSERT_THROW(s.slice(5, 10), IndexOutOfRange);
+  // Запись через неконстантный итератор задаёт элемент
+  ArraySequence<int> blank(3);
+  ASSERT_THROW(blank.get(1), IndexOutOfRange);
+  blank.begin()[1] = 7;
+  ASSERT_EQ(7, blank.get(1));
+  // Представление-подпоследовательность
+  Sequence<int> *view = s.getSubsequenceView(2, 5);
+  ASSERT_EQ(4, view->getLength());
+  ASSERT_EQ(3, view->getFirst());
+  ASSERT_EQ(6, view->getLast());
+  s[3] = 40;  // Изменение исходной последовательности видно в представлении
+  ASSERT_EQ(40, view->get(1));
+  view->append(100);  // Изменение представления не трогает исходную последовательность
+  ASSERT_EQ(5, view->getLength());
+  ASSERT_EQ(100, view->getLast());
+  ASSERT_EQ(10, s.getLength());
+  delete view;
+  // Копирующая подпоследовательность и сцепление одним блоком
+  Sequence<int> *sub = s.getSubsequence(0, 2);
+  ASSERT_EQ(3, sub->getLength());
+  ASSERT_THROW(s.getSubsequence(8, 10), IndexOutOfRange);
+  Sequence<int> *joined = s.concat(sub);
+  ASSERT_EQ(13, joined->getLength());
+  ASSERT_EQ(3, joined->getLast());
+  ArraySequence<int> tail;
+  tail.appendRange(s.slice(8, 9));
+  ASSERT_EQ(9, tail.getFirst());
+  ASSERT_EQ(10, tail.getLast());
+  delete sub;
+  delete joined;
+  // Незаданные элементы остаются незаданными в подпоследовательности
+  ArraySequence<int> sparse(4);
+  sparse[1] = 5;
+  Sequence<int> *sparseSub = sparse.getSubsequence(1, 2);
+  ASSERT_EQ(5, sparseSub->get(0));
+  ASSERT_THROW(sparseSub->get(1), IndexOutOfRange);
+  delete sparseSub;
+}
+
 TEST(SortedSequence, basic) {
   SortedSequence<int> s;
   ASSERT_EQ(0, s.getLength());
@@ -65,6 +802,63 @@ TEST(SortedSequence, basic) {
   ASSERT_EQ(10, sub[1]);
 }
 
+TEST(SortedSequence, bounds_and_batches) {
+  SortedSequence<int> s;
+  for (int x : {7, 3, 3, 9, 1}) s.add(x);
+  ASSERT_EQ(1, s.lower_bound(3));
+  ASSERT_EQ(3, s.upper_bound(3));
+  ASSERT_EQ(5, s.lower_bound(100));
+  ASSERT_TRUE(s.contains(9));
+  ASSERT_FALSE(s.contains(4));
+  ASSERT_EQ(-1, s.indexOf(4));
+  // Пачка сливается с уже имеющимися элементами за один проход
+  vector<int> batch = {8, 0, 3, 10};
+  s.addRange(batch.begin(), batch.end());
+  ASSERT_EQ(9, s.getLength());
+  for (int i = 1; i < s.getLength(); i++) ASSERT_LE(s.get(i - 1), s.get(i));
+  ASSERT_EQ(0, s.getFirst());
+  ASSERT_EQ(10, s.getLast());
+  // Буферизованный режим: длина учитывает отложенные элементы, чтение сливает буфер
+  s.beginBatch();
+  for (int i = 1000; i > 0; i--) s.add(i * 2);
+  ASSERT_EQ(1009, s.getLength());
+  ASSERT_EQ(2000, s.getLast());
+  s.add(5);
+  s.endBatch();
+  ASSERT_EQ(1010, s.getLength());
+  for (int i = 1; i < s.getLength(); i++) ASSERT_LE(s.get(i - 1), s.get(i));
+  ASSERT_EQ(s.lower_bound(5), s.indexOf(5));
+  SortedSequence<int> sub = s.getSubsequence(2, 5);
+  ASSERT_EQ(4, sub.getLength());
+  ASSERT_EQ(s.get(2), sub.getFirst());
+  // Чтение во время пачки ищет и в массиве, и в буфере: результат тот же, что после слияния
+  const SortedSequence<int> &view = s;
+  vector<int> expected;
+  for (int i = 0; i < s.getLength(); i++) expected.push_back(s.get(i));
+  s.beginBatch();
+  for (int x : {1, 5, 3000, -1, 5, 999}) {
+    s.add(x);
+    expected.insert(std::upper_bound(expected.begin(), expected.end(), x), x);
+  }
+  ASSERT_EQ(expected.size(), view.getLength());
+  for (int i = 0; i < expected.size(); i++) ASSERT_EQ(expected[i], view.get(i));
+  ASSERT_EQ(-1, view.getFirst());
+  ASSERT_EQ(3000, view.getLast());
+  for (int x : {-2, 1, 5, 999, 1000, 3000, 3001}) {
+    ASSERT_EQ(std::lower_bound(expected.begin(), expected.end(), x) - expected.begin(), view.lower_bound(x));
+    ASSERT_EQ(std::upper_bound(expected.begin(), expected.end(), x) - expected.begin(), view.upper_bound(x));
+  }
+  ASSERT_TRUE(view.contains(999));
+  ASSERT_EQ(-1, view.indexOf(2001));
+  SortedSequence<int> middle = view.getSubsequence(1, 20);
+  ASSERT_EQ(20, middle.getLength());
+  for (int i = 0; i < 20; i++) ASSERT_EQ(expected[i + 1], middle.get(i));
+  ASSERT_THROW(view.get(int(expected.size())), IndexOutOfRange);
+  ASSERT_THROW(view.getSubsequence(0, int(expected.size())), IndexOutOfRange);
+  s.endBatch();
+  for (int i = 0; i < expected.size(); i++) ASSERT_EQ(expected[i], view.get(i));
+}
+
 TEST(BTree, int_basic) {
   BTree<int> t(3);  // A B-Tree with minimum degree 3
 
@@ -120,6 +914,253 @@ TEST(BTree, string_basic) {
   (t.search(k) != nullptr) ? cout << "\nPresent" : cout << "\nNot Present";
 }
 
+TEST(BTree, remove_and_iterate) {
+  BTree<int> t(3);
+  multiset<int> expected;
+  mt19937 gen(3);
+  for (int i = 0; i < 3000; i++) {
+    int x = int(gen() % 1000);
+    t.insert(x);
+    expected.insert(x);
+  }
+  for (int i = 0; i < 2000; i++) {
+    int x = int(gen() % 1100);
+    bool has = expected.count(x) > 0;
+    if (has) expected.erase(expected.find(x));
+    ASSERT_EQ(has, t.remove(x)) << x;
+  }
+  // Прямой обход совпадает с multiset
+  ASSERT_TRUE(equal(t.begin(), t.end(), expected.begin(), expected.end()));
+  // Обратный обход
+  vector<int> backward;
+  for (auto it = t.end(); it != t.begin();) backward.push_back(*--it);
+  ASSERT_TRUE(equal(backward.begin(), backward.end(), expected.rbegin(), expected.rend()));
+  // lower_bound / upper_bound
+  for (int x = -1; x <= 1001; x++) {
+    auto lb = t.lower_bound(x);
+    auto elb = expected.lower_bound(x);
+    ASSERT_EQ(elb == expected.end(), lb == t.end());
+    if (elb != expected.end()) {
+      ASSERT_EQ(*elb, *lb);
+    }
+    ASSERT_EQ(distance(expected.lower_bound(x), expected.upper_bound(x)), distance(lb, t.upper_bound(x)));
+  }
+  // Удаление всех ключей
+  for (int x : expected) ASSERT_TRUE(t.remove(x));
+  ASSERT_TRUE(t.begin() == t.end());
+  ASSERT_FALSE(t.found(0));
+}
+
+TEST(BTree, bulkLoad) {
+  for (int n : {0, 1, 4, 5, 6, 11, 12, 13, 100, 1234}) {
+    vector<int> keys(n);
+    for (int i = 0; i < n; i++) keys[i] = i * 2;
+    BTree<int> t(3);
+    t.bulkLoad(keys.begin(), keys.end());
+    ASSERT_TRUE(equal(t.begin(), t.end(), keys.begin(), keys.end())) << n;
+    for (int i = 0; i < n; i++) {
+      ASSERT_TRUE(t.found(i * 2));
+      ASSERT_FALSE(t.found(i * 2 + 1));
+    }
+    // После построения дерево остаётся корректным для вставки и удаления
+    t.insert(-1);
+    ASSERT_EQ(-1, *t.begin());
+    for (int i = 0; i < n; i += 3) ASSERT_TRUE(t.remove(i * 2));
+    ASSERT_TRUE(t.remove(-1));
+  }
+  vector<int> unsorted = {3, 1, 2};
+  BTree<int> t(2);
+  ASSERT_THROW(t.bulkLoad(unsorted.begin(), unsorted.end()), runtime_error);
+}
+
+TEST(FlatBTree, int_matches_btree) {
+  FlatBTree<int, 4> flat;
+  BTree<int> t(4);
+  mt19937 gen(1);
+  for (int i = 0; i < 5000; i++) {
+    int x = int(gen() % 20000);
+    flat.insert(x);
+    t.insert(x);
+  }
+  ASSERT_EQ(5000, flat.size());
+  for (int x = -5; x < 20005; x++) {
+    ASSERT_EQ(t.found(x), flat.found(x)) << x;
+  }
+}
+
+TEST(FlatBTree, string_keys) {
+  FlatBTree<string, 3> t;
+  ASSERT_FALSE(t.found("test"));
+  for (int i = 0; i < 200; i += 2) t.insert(to_string(i));
+  for (int i = 0; i < 200; i++) {
+    ASSERT_EQ(i % 2 == 0, t.found(to_string(i)));
+  }
+  ASSERT_EQ("42", *t.search("42"));
+}
+
+// Сравнение скорости поиска BTree и FlatBTree
+TEST(FlatBTree, lookup_throughput) {
+  const int N = 200000;
+  vector<int> keys(N);
+  mt19937 gen(2);
+  for (int &k : keys) k = int(gen() % (N * 4));
+  BTree<int> t(16);
+  FlatBTree<int, 16> flat;
+  for (int k : keys) {
+    t.insert(k);
+    flat.insert(k);
+  }
+  int hits1 = 0, hits2 = 0;
+  auto begin = chrono::steady_clock::now();
+  for (int x = 0; x < N * 4; x++) hits1 += t.found(x);
+  auto middle = chrono::steady_clock::now();
+  for (int x = 0; x < N * 4; x++) hits2 += flat.found(x);
+  auto end = chrono::steady_clock::now();
+  ASSERT_EQ(hits1, hits2);
+  cout << "BTree: " << chrono::duration_cast<chrono::microseconds>(middle - begin).count() / 1e3 << " ms, "
+       << "FlatBTree: " << chrono::duration_cast<chrono::microseconds>(end - middle).count() / 1e3 << " ms\n";
+}
+
+TEST(ConcurrentBTree, single_thread) {
+  ConcurrentBTree<int, 4> t;
+  set<int> expected;
+  mt19937 gen(4);
+  for (int i = 0; i < 5000; i++) {
+    int x = int(gen() % 10000);
+    ASSERT_EQ(expected.insert(x).second, t.insert(x));
+  }
+  ASSERT_EQ(expected.size(), t.size());
+  for (int x = -1; x <= 10000; x++) ASSERT_EQ(expected.count(x) > 0, t.found(x)) << x;
+}
+
+// Несколько писателей вставляют непересекающиеся диапазоны, читатели параллельно
+// проверяют, что уже опубликованные ключи находятся, а ещё не вставленные - нет
+TEST(ConcurrentBTree, stress) {
+  const int WRITERS = 2, READERS = 4, PER_WRITER = 20000;
+  ConcurrentBTree<int, 8> t;
+  atomic<int> published[WRITERS];
+  for (auto &p : published) p = 0;
+  atomic<bool> stop{false};
+  atomic<int> errors{0};
+  vector<thread> threads;
+  for (int w = 0; w < WRITERS; w++) {
+    threads.emplace_back([&, w]() {
+      for (int i = 0; i < PER_WRITER; i++) {
+        // Ключи писателя w: w, w + WRITERS, w + 2 * WRITERS, ...
+        if (!t.insert(i * WRITERS + w)) errors++;
+        published[w].store(i + 1, memory_order_release);
+      }
+    });
+  }
+  for (int r = 0; r < READERS; r++) {
+    threads.emplace_back([&, r]() {
+      mt19937 gen(r);
+      while (!stop.load()) {
+        int w = int(gen() % WRITERS);
+        int done = published[w].load(memory_order_acquire);
+        if (done > 0 && !t.found(int(gen() % done) * WRITERS + w)) errors++;
+        if (t.found(-1 - int(gen() % 100))) errors++;
+      }
+    });
+  }
+  for (int w = 0; w < WRITERS; w++) threads[w].join();
+  stop = true;
+  for (int i = WRITERS; i < threads.size(); i++) threads[i].join();
+  ASSERT_EQ(0, errors.load());
+  ASSERT_EQ(WRITERS * PER_WRITER, t.size());
+  for (int x = 0; x < WRITERS * PER_WRITER; x++) ASSERT_TRUE(t.found(x));
+}
+
+// Пропускная способность читателей при одном писателе:
+// ConcurrentBTree против FlatBTree под глобальным мьютексом
+TEST(ConcurrentBTree, throughput_vs_global_mutex) {
+  const int READERS = 4, KEYS = 100000, LOOKUPS = 200000;
+  auto run = [&](auto insert, auto find) {
+    for (int i = 0; i < KEYS; i += 2) insert(i);
+    auto begin = chrono::steady_clock::now();
+    vector<thread> threads;
+    threads.emplace_back([&]() {
+      for (int i = 1; i < KEYS; i += 2) insert(i);
+    });
+    atomic<int> hits{0};
+    for (int r = 0; r < READERS; r++) {
+      threads.emplace_back([&, r]() {
+        int local = 0;
+        for (int i = 0; i < LOOKUPS; i++) local += find((i * 7919 + r) % KEYS);
+        hits += local;
+      });
+    }
+    for (auto &th : threads) th.join();
+    auto end = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::microseconds>(end - begin).count() / 1e3;
+  };
+  ConcurrentBTree<int> concurrent;
+  double olc = run([&](int k) { concurrent.insert(k); }, [&](int k) { return concurrent.found(k); });
+  FlatBTree<int> flat;
+  mutex m;
+  double locked = run(
+      [&](int k) {
+        lock_guard<mutex> lock(m);
+        flat.insert(k);
+      },
+      [&](int k) {
+        lock_guard<mutex> lock(m);
+        return flat.found(k);
+      });
+  ASSERT_EQ(KEYS, concurrent.size());
+  ASSERT_EQ(KEYS, flat.size());
+  cout << "ConcurrentBTree: " << olc << " ms, global mutex: " << locked << " ms\n";
+}
+
+TEST(PagedBTree, reopen) {
+  const char *fileName = "paged_btree_test.idx";
+  remove(fileName);
+  vector<int> keys(20000);
+  mt19937 gen(5);
+  for (int &k : keys) k = int(gen() % 1000000);
+  {
+    PagedBTree<int> t(fileName);
+    for (int k : keys) t.insert(k);
+    ASSERT_EQ(keys.size(), t.size());
+  }
+  // Повторное открытие - без перестроения
+  {
+    PagedBTree<int> t(fileName);
+    ASSERT_EQ(keys.size(), t.size());
+    for (int k : keys) ASSERT_TRUE(t.found(k));
+    ASSERT_FALSE(t.found(-1));
+    vector<int> all;
+    t.forEach([&all](int k) { all.push_back(k); });
+    sort(keys.begin(), keys.end());
+    ASSERT_EQ(keys, all);
+  }
+  // Файл с другим размером ключа не открывается
+  auto openFiles = []() { return distance(filesystem::directory_iterator("/proc/self/fd"), {}); };
+  auto before = openFiles();
+  ASSERT_THROW(PagedBTree<long long> t(fileName), runtime_error);
+  // Размер /dev/null не меняется - ошибка в map; файл всё равно закрывается
+  ASSERT_THROW(PagedBTree<int> t("/dev/null"), runtime_error);
+  ASSERT_EQ(before, openFiles());
+  remove(fileName);
+}
+
+TEST(PagedBTree, fixed_string_keys) {
+  const char *fileName = "paged_btree_strings.idx";
+  remove(fileName);
+  {
+    PagedBTree<FixedKey<16>, 512> t(fileName);
+    for (int i = 0; i < 1000; i += 2) t.insert(to_string(i));
+  }
+  PagedBTree<FixedKey<16>, 512> t(fileName);
+  for (int i = 0; i < 1000; i++) ASSERT_EQ(i % 2 == 0, t.found(to_string(i)));
+  string first;
+  t.forEach([&first](const FixedKey<16> &k) {
+    if (first.empty()) first = k.str();
+  });
+  ASSERT_EQ("0", first);
+  remove(fileName);
+}
+
 //
 // 4 способа укладки:
 //          #        #
@@ -174,7 +1215,134 @@ TEST(Item, genAllRotations_krivulya) {
   ASSERT_EQ("### # ", r[2]);
 }
 
+// Таблицы поворотов вычисляются при компиляции
+constexpr auto squareTable = compileShape({"@@", "@@"});
+constexpr auto hTable = compileShape({"@@@", " @ ", "@@@"});
+constexpr auto lTable = compileShape({"@", "@", "@@"});
+static_assert(squareTable.count == 1 && squareTable.cells == 4);
+static_assert(hTable.count == 2 && hTable.cells == 7);  // Симметрична
+static_assert(lTable.count == 8 && lTable[0].height == 2 && lTable[0].width == 3);
+static_assert(compileShape({"  ", " @@"})[1].bits == 0b11, "shapes are normalized");
+
+TEST(Item, compiledOrientations) {
+  // Порядок и изображения те же, что у genAllRotations
+  for (Shape shape : {Shape{"@", "@", "@", "@"}, Shape{"@", "@", "@@"}, Shape{"@@@", " @", "@@@"},
+                      Shape{" @", "@@@@", " @ @@@"}}) {
+    auto expected = genAllRotations(shape);
+    auto table = compileShape(shape);
+    ASSERT_EQ(expected.size(), table.count);
+    int k = 0;
+    for (auto &image : expected) {
+      Shape compiled = table[k++].toShape();
+      for (auto &row : compiled) row.resize(image[0].size(), ' ');
+      ASSERT_EQ(image, compiled);
+    }
+  }
+  ASSERT_THROW(compileShape(Shape{"@@@@@@@@@"}), runtime_error);
+}
+
+TEST(BackPack, fixedGridSolver) {
+  Config cfg("../input.txt");
+  auto expected = BacktrackSolver(cfg.backPack).solve(cfg.items);
+  FixedGridSolver<7, 12> solver(cfg.backPack);
+  auto solutions = solver.solve(cfg.items);
+  ASSERT_EQ(expected.size(), solutions.size());
+  for (auto a = expected.begin(), b = solutions.begin(); a != expected.end(); ++a, ++b) {
+    ASSERT_EQ(a->price, b->price);
+    ASSERT_EQ(a->weight, b->weight);
+    ASSERT_EQ(a->shape, b->shape);
+    ASSERT_EQ(a->freeCells, b->freeCells);
+  }
+  BacktrackSolver reference(cfg.backPack);
+  reference.solve(cfg.items);
+  ASSERT_EQ(reference.nodes(), solver.nodes());
+  // Предметы каталога с таблицами, посчитанными при компиляции
+  vector<CatalogItem> catalog = {{5, 10, compileShape({"@", "@", "@", "@"})},
+                                 {10, 10, compileShape({"@", "@", "@", "@@"})},
+                                 {10, 15, squareTable},
+                                 {20, 20, hTable}};
+  SolverOptions options;
+  options.maxWeight = cfg.maxWeight;
+  auto limited = BacktrackSolver(cfg.backPack, options).solve(cfg.items);
+  auto fromCatalog = FixedGridSolver<7, 12>(cfg.backPack, cfg.maxWeight).solve(catalog);
+  ASSERT_EQ(limited.size(), fromCatalog.size());
+  for (auto a = limited.begin(), b = fromCatalog.begin(); a != limited.end(); ++a, ++b) ASSERT_EQ(a->shape, b->shape);
+  ASSERT_THROW((FixedGridSolver<6, 12>(cfg.backPack)), runtime_error);
+  // Рюкзак во всю сетку: фигуры у правого и нижнего края отсекаются занятыми битами за сеткой
+  BackPack full({"____", "____"}, 0, 0);
+  Item bar(1, 4), corner(1, 3);
+  bar.shape = {"@@@@"};
+  corner.shape = {"@@", "@ "};
+  vector<Item *> edge = {&bar, &corner};
+  auto edgeExpected = BacktrackSolver(full).solve(edge);
+  auto edgeFound = FixedGridSolver<2, 4>(full).solve(edge);
+  ASSERT_EQ(edgeExpected.size(), edgeFound.size());
+  for (auto a = edgeExpected.begin(), b = edgeFound.begin(); a != edgeExpected.end(); ++a, ++b)
+    ASSERT_EQ(a->shape, b->shape);
+}
+
 TEST(Backpack, solveBackpack) {
   ASSERT_EQ(solveBackpack("../backpack_a.txt"), 40);
   ASSERT_EQ(solveBackpack("../backpack_Aa.txt"), 58638);
+}
+TEST(Tree, map_where_reduce) {
+  Tree<int, 3> t;
+  for (int i = 1; i <= 10; i++) t.insert(i);
+  ASSERT_TRUE(t.find(7));
+  ASSERT_FALSE(t.find(11));
+  Tree<int, 3> *squares = t.map([](int x) { return x * x; });
+  ASSERT_TRUE(squares->find(100));
+  ASSERT_EQ(385, squares->reduce([](int a, int b) { return a + b; }));
+  Tree<int, 3> *even = t.where([](int x) { return x % 2 == 0; });
+  ASSERT_TRUE(even->find(4));
+  ASSERT_FALSE(even->find(5));
+  ASSERT_EQ(30, even->reduce([](int a, int b) { return a + b; }));
+  delete squares;
+  delete even;
+}
+
+TEST(ImplicitTree, layout_and_ops) {
+  using ITree = ImplicitTree<int, 4>;
+  ITree t;
+  for (int i = 0; i < 1000; i++) t.insert(i);
+  ASSERT_EQ(1000, t.getSize());
+  // Дети узла i - 4i+1..4i+4, значения совпадают с индексами
+  ASSERT_EQ(5, t.get(ITree::child(1, 0)));
+  ASSERT_EQ(8, t.get(ITree::child(1, 3)));
+  ASSERT_EQ(1, ITree::parent(8));
+  ASSERT_EQ(-1, ITree::parent(0));
+  ASSERT_TRUE(t.find(999));
+  ASSERT_TRUE(t.find(130));
+  ASSERT_FALSE(t.find(1000));
+  ITree *doubled = t.map([](int x) { return 2 * x; });
+  ASSERT_EQ(1000, doubled->getSize());
+  ASSERT_EQ(1998, doubled->get(999));
+  ITree *odd = t.where([](int x) { return x % 2 == 1; });
+  ASSERT_EQ(500, odd->getSize());
+  ASSERT_EQ(250000, odd->reduce([](int a, int b) { return a + b; }));
+  ASSERT_THROW((ITree().reduce([](int a, int b) { return a + b; })), IndexOutOfRange);
+  delete doubled;
+  delete odd;
+}
+
+TEST(Tree, parallel_reduce_and_deep_trees) {
+  // Глубокая цепочка: рекурсивный обход переполнил бы стек
+  Tree<long long, 2> deep;
+  for (int i = 1; i <= 1000000; i++) deep.insert(i);
+  auto sum = [](long long a, long long b) { return a + b; };
+  ASSERT_EQ(500000500000LL, deep.reduce(sum));
+  ASSERT_EQ(500000500000LL, deep.reduceParallel(sum));
+  ASSERT_TRUE(deep.find(999999));
+  // Порядок операндов совпадает с последовательным reduce (конкатенация не коммутативна)
+  Tree<string, 4> t;
+  for (int i = 0; i < 2000; i++) t.insert(to_string(i % 10));
+  auto concat = [](const string &a, const string &b) { return a + b; };
+  string expected = t.reduce(concat);
+  for (int cutoff : {0, 1, 3, 10}) ASSERT_EQ(expected, t.reduceParallel(concat, cutoff)) << cutoff;
+  // Параллельный обход посещает каждый узел ровно один раз
+  atomic<int> visited{0};
+  t.visitParallel([&visited](const string &) { visited++; }, 5);
+  ASSERT_EQ(2000, visited.load());
+  Tree<int, 3> empty;
+  ASSERT_THROW(empty.reduce([](int a, int b) { return a + b; }), IndexOutOfRange);
 }
\ No newline at end of file